@@ -0,0 +1,33 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * bench-dep: DT_NEEDED fodder for the gadgets made by ug-bench-gen, built
+ * once per BENCH_DEP_ID
+ */
+
+#define BENCH_DEP_NAME(id) BENCH_DEP_NAME_(id)
+#define BENCH_DEP_NAME_(id) bench_dep_##id
+
+__attribute__ ((visibility("default")))
+void BENCH_DEP_NAME(BENCH_DEP_ID) (void)
+{
+}
@@ -0,0 +1,102 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* bench-null: a gadget that does nothing but answer, for ug-bench */
+
+#include <stdlib.h>
+
+#include <ui-gadget-module.h>
+
+#ifndef UG_MODULE_API
+#define UG_MODULE_API __attribute__ ((visibility("default")))
+#endif
+
+struct bench_null {
+	int layout;
+};
+
+static void *on_create(ui_gadget_h ug, enum ug_mode mode, service_h service,
+		       void *priv)
+{
+	/* any non-NULL layout will do without an engine */
+	return priv;
+}
+
+static void on_start(ui_gadget_h ug, service_h service, void *priv)
+{
+}
+
+static void on_pause(ui_gadget_h ug, service_h service, void *priv)
+{
+}
+
+static void on_resume(ui_gadget_h ug, service_h service, void *priv)
+{
+}
+
+static void on_destroy(ui_gadget_h ug, service_h service, void *priv)
+{
+}
+
+static void on_message(ui_gadget_h ug, service_h msg, service_h service,
+		       void *priv)
+{
+	/* round trip: the caller's result_cb gets the message back */
+	ug_send_result(ug, msg);
+}
+
+static void on_event(ui_gadget_h ug, enum ug_event event, service_h service,
+		     void *priv)
+{
+}
+
+UG_MODULE_API int UG_MODULE_INIT(struct ug_module_ops *ops)
+{
+	struct bench_null *priv;
+
+	if (!ops)
+		return -1;
+
+	priv = calloc(1, sizeof(struct bench_null));
+	if (!priv)
+		return -1;
+
+	ops->create = on_create;
+	ops->start = on_start;
+	ops->pause = on_pause;
+	ops->resume = on_resume;
+	ops->destroy = on_destroy;
+	ops->message = on_message;
+	ops->event = on_event;
+	/* leaves ug-bench a broadcast nobody takes */
+	ops->event_mask = UG_EVENT_MASK_ALL &
+	    ~UG_EVENT_MASK(UG_EVENT_REGION_CHANGE);
+	ops->priv = priv;
+	ops->opt = UG_OPT_INDICATOR_ENABLE;
+
+	return 0;
+}
+
+UG_MODULE_API void UG_MODULE_EXIT(struct ug_module_ops *ops)
+{
+	if (ops)
+		free(ops->priv);
+}
@@ -0,0 +1,122 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+static int bench_report_first;
+
+int bench_samples_init(struct bench_samples *s, const char *name,
+		       unsigned int size)
+{
+	s->name = name;
+	s->count = 0;
+	s->size = size ? size : 1;
+	s->ns = calloc(s->size, sizeof(uint64_t));
+
+	return s->ns ? 0 : -1;
+}
+
+void bench_samples_add(struct bench_samples *s, uint64_t ns)
+{
+	uint64_t *p;
+
+	if (s->count == s->size) {
+		p = realloc(s->ns, s->size * 2 * sizeof(uint64_t));
+		if (!p)
+			return;
+		s->ns = p;
+		s->size *= 2;
+	}
+
+	s->ns[s->count++] = ns;
+}
+
+void bench_samples_free(struct bench_samples *s)
+{
+	free(s->ns);
+	s->ns = NULL;
+	s->count = 0;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* nearest-rank percentile of sorted samples */
+static uint64_t bench_pct(struct bench_samples *s, unsigned int pct)
+{
+	unsigned int rank;
+
+	rank = (s->count * pct + 99) / 100;
+	if (rank)
+		rank--;
+
+	return s->ns[rank];
+}
+
+void bench_report_begin(FILE *fp, const char *tool)
+{
+	bench_report_first = 1;
+	fprintf(fp, "{\n  \"tool\": \"%s\",\n  \"unit\": \"ns\",\n"
+		"  \"results\": [", tool);
+}
+
+void bench_report_samples(FILE *fp, struct bench_samples *s,
+			  const char *params)
+{
+	uint64_t sum = 0;
+	unsigned int i;
+
+	if (!s->count)
+		return;
+
+	qsort(s->ns, s->count, sizeof(uint64_t), bench_cmp);
+	for (i = 0; i < s->count; i++)
+		sum += s->ns[i];
+
+	fprintf(fp, "%s\n    { \"name\": \"%s\", \"params\": %s, "
+		"\"samples\": %u, \"min\": %llu, \"p50\": %llu, "
+		"\"p90\": %llu, \"p99\": %llu, \"max\": %llu, "
+		"\"mean\": %llu }",
+		bench_report_first ? "" : ",", s->name,
+		params ? params : "{}", s->count,
+		(unsigned long long)s->ns[0],
+		(unsigned long long)bench_pct(s, 50),
+		(unsigned long long)bench_pct(s, 90),
+		(unsigned long long)bench_pct(s, 99),
+		(unsigned long long)s->ns[s->count - 1],
+		(unsigned long long)(sum / s->count));
+
+	bench_report_first = 0;
+}
+
+void bench_report_end(FILE *fp)
+{
+	fprintf(fp, "\n  ]\n}\n");
+}
@@ -0,0 +1,77 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+struct bench_samples {
+	const char *name;
+	uint64_t *ns;
+	unsigned int count;
+	unsigned int size;
+};
+
+static inline uint64_t bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Synthetic gadgets made by ug-bench-gen stamp bench_now() into
+ * BENCH_MARKS_SYM as they load, so ug-bench-load can split the load time.
+ * BENCH_PARAMS_SYM is the JSON object of the parameters they were made with.
+ */
+#define BENCH_MARKS_SYM "bench_module_marks"
+#define BENCH_PARAMS_SYM "bench_module_params"
+
+enum bench_mark {
+	BENCH_MARK_CTOR_BEGIN,
+	BENCH_MARK_CTOR_END,
+	BENCH_MARK_INIT_BEGIN,
+	BENCH_MARK_INIT_END,
+	BENCH_MARK_MAX,
+};
+
+/* stand-in main loop: runs queued idlers, due timers and jobs */
+int bench_loop_run(void);
+
+int bench_samples_init(struct bench_samples *s, const char *name,
+		       unsigned int size);
+void bench_samples_add(struct bench_samples *s, uint64_t ns);
+void bench_samples_free(struct bench_samples *s);
+
+/*
+ * JSON report: bench_report_begin(), then one bench_report_samples() per
+ * measurement with a preformatted "params" object, then bench_report_end()
+ */
+void bench_report_begin(FILE *fp, const char *tool);
+void bench_report_samples(FILE *fp, struct bench_samples *s,
+			  const char *params);
+void bench_report_end(FILE *fp);
+
+#endif				/* __BENCH_H__ */
@@ -0,0 +1,338 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * Stand-ins for the platform pieces ui-gadget-1 uses, so the library
+ * sources run headless on a plain Linux box: no X server, no window
+ * manager, no EFL main loop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Ecore.h>
+#include <app.h>
+#include <app_manager.h>
+#include <utilX.h>
+
+#include "bench.h"
+
+enum bench_task_type {
+	BENCH_TASK_IDLER,
+	BENCH_TASK_TIMER,
+	BENCH_TASK_JOB,
+};
+
+struct _Ecore_Idler {
+	enum bench_task_type type;
+	Ecore_Task_Cb func;
+	Ecore_Cb job;
+	void *data;
+	double at;
+	int dead;
+	struct _Ecore_Idler *next;
+};
+
+struct bench_loop {
+	struct _Ecore_Idler *head;
+	struct _Ecore_Idler *tail;
+};
+
+static struct bench_loop loop;
+
+/* a renewing idler that never finishes must not hang the benchmark */
+#define BENCH_LOOP_MAX_PASSES 100000
+
+struct service_s {
+	int refs;
+};
+
+static struct _Ecore_Idler *bench_task_add(enum bench_task_type type,
+					   const void *data)
+{
+	struct _Ecore_Idler *t;
+
+	t = calloc(1, sizeof(struct _Ecore_Idler));
+	if (!t)
+		return NULL;
+
+	t->type = type;
+	t->data = (void *)data;
+
+	if (loop.tail)
+		loop.tail->next = t;
+	else
+		loop.head = t;
+	loop.tail = t;
+
+	return t;
+}
+
+Ecore_Idler *ecore_idler_add(Ecore_Task_Cb func, const void *data)
+{
+	Ecore_Idler *t = bench_task_add(BENCH_TASK_IDLER, data);
+
+	if (t)
+		t->func = func;
+	return t;
+}
+
+void *ecore_idler_del(Ecore_Idler *idler)
+{
+	void *data = NULL;
+
+	if (idler) {
+		idler->dead = 1;
+		data = idler->data;
+	}
+	return data;
+}
+
+Ecore_Timer *ecore_timer_add(double in, Ecore_Task_Cb func, const void *data)
+{
+	Ecore_Timer *t = bench_task_add(BENCH_TASK_TIMER, data);
+
+	if (t) {
+		t->func = func;
+		t->at = ecore_time_get() + in;
+	}
+	return t;
+}
+
+void *ecore_timer_del(Ecore_Timer *timer)
+{
+	return ecore_idler_del(timer);
+}
+
+Ecore_Job *ecore_job_add(Ecore_Cb func, const void *data)
+{
+	Ecore_Job *t = bench_task_add(BENCH_TASK_JOB, data);
+
+	if (t)
+		t->job = func;
+	return t;
+}
+
+void *ecore_job_del(Ecore_Job *job)
+{
+	return ecore_idler_del(job);
+}
+
+Ecore_Animator *ecore_animator_add(Ecore_Task_Cb func, const void *data)
+{
+	return ecore_idler_add(func, data);
+}
+
+void *ecore_animator_del(Ecore_Animator *animator)
+{
+	return ecore_idler_del(animator);
+}
+
+struct bench_thread {
+	Ecore_Thread_Cb end;
+	void *data;
+};
+
+static void bench_thread_end(void *data)
+{
+	struct bench_thread *th = data;
+
+	th->end(th->data, NULL);
+	free(th);
+}
+
+/* the blocking part runs inline, completion is posted to the loop */
+Ecore_Thread *ecore_thread_run(Ecore_Thread_Cb func_blocking,
+			       Ecore_Thread_Cb func_end,
+			       Ecore_Thread_Cb func_cancel, const void *data)
+{
+	struct bench_thread *th;
+
+	th = calloc(1, sizeof(struct bench_thread));
+	if (!th) {
+		if (func_cancel)
+			func_cancel((void *)data, NULL);
+		return NULL;
+	}
+
+	func_blocking((void *)data, NULL);
+
+	th->end = func_end;
+	th->data = (void *)data;
+	ecore_job_add(bench_thread_end, th);
+
+	return (Ecore_Thread *)th;
+}
+
+double ecore_time_get(void)
+{
+	return bench_now() / 1e9;
+}
+
+int ECORE_EVENT_SIGNAL_USER = 1;
+
+Ecore_Event_Handler *ecore_event_handler_add(int type,
+					     Ecore_Event_Handler_Cb func,
+					     const void *data)
+{
+	static int handler;
+
+	return (Ecore_Event_Handler *)&handler;
+}
+
+void *ecore_event_handler_del(Ecore_Event_Handler *handler)
+{
+	return NULL;
+}
+
+int bench_loop_run(void)
+{
+	struct _Ecore_Idler *t;
+	struct _Ecore_Idler **pp;
+	int passes = 0;
+	int ran = 0;
+	int busy = 1;
+	double now;
+
+	while (busy && passes++ < BENCH_LOOP_MAX_PASSES) {
+		busy = 0;
+		now = ecore_time_get();
+
+		/* tasks added while running are appended and run in this pass */
+		for (t = loop.head; t; t = t->next) {
+			if (t->dead)
+				continue;
+			if (t->type == BENCH_TASK_TIMER && t->at > now)
+				continue;
+
+			busy = 1;
+			ran++;
+
+			if (t->type == BENCH_TASK_JOB) {
+				t->dead = 1;
+				t->job(t->data);
+			} else if (!t->func(t->data)) {
+				t->dead = 1;
+			}
+		}
+
+		pp = &loop.head;
+		loop.tail = NULL;
+		while (*pp) {
+			t = *pp;
+			if (t->dead) {
+				*pp = t->next;
+				free(t);
+			} else {
+				loop.tail = t;
+				pp = &t->next;
+			}
+		}
+	}
+
+	return ran;
+}
+
+void elm_object_signal_emit(void *obj, const char *emission,
+			    const char *source)
+{
+}
+
+int service_create(service_h *service)
+{
+	*service = calloc(1, sizeof(struct service_s));
+	return *service ? 0 : -1;
+}
+
+int service_clone(service_h *clone, service_h service)
+{
+	*clone = NULL;
+	if (!service)
+		return -1;
+
+	return service_create(clone);
+}
+
+int service_destroy(service_h service)
+{
+	free(service);
+	return 0;
+}
+
+int service_add_extra_data(service_h service, const char *key,
+			   const char *value)
+{
+	return service ? 0 : -1;
+}
+
+int service_to_bundle(service_h service, bundle **data)
+{
+	*data = NULL;
+	return -1;
+}
+
+void bundle_foreach(bundle *b, bundle_iterator_t iter, void *user_data)
+{
+}
+
+int app_manager_get_package(pid_t pid, char **package)
+{
+	*package = NULL;
+	return -1;
+}
+
+int utilx_get_indicator_state(Display *dpy, Window win)
+{
+	return 1;
+}
+
+void utilx_enable_indicator(Display *dpy, Window win, int enable)
+{
+}
+
+Window XDefaultRootWindow(Display *dpy)
+{
+	return 1;
+}
+
+Atom XInternAtom(Display *dpy, const char *name, Bool only_if_exists)
+{
+	return 1;
+}
+
+int XGetWindowProperty(Display *dpy, Window w, Atom property,
+		       long long_offset, long long_length, Bool delete,
+		       Atom req_type, Atom *actual_type_return,
+		       int *actual_format_return,
+		       unsigned long *nitems_return,
+		       unsigned long *bytes_after_return,
+		       unsigned char **prop_return)
+{
+	*prop_return = NULL;
+	return BadImplementation;
+}
+
+int XFree(void *data)
+{
+	free(data);
+	return 0;
+}
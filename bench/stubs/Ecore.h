@@ -0,0 +1,85 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * ug-bench stand-in for Ecore: idlers, timers, jobs and threads are queued
+ * and run by bench_loop_run() (see bench.h), there is no real main loop.
+ */
+
+#ifndef __BENCH_ECORE_H__
+#define __BENCH_ECORE_H__
+
+#include <stdbool.h>
+
+typedef unsigned char Eina_Bool;
+
+#define EINA_TRUE ((Eina_Bool)1)
+#define EINA_FALSE ((Eina_Bool)0)
+
+#define ECORE_CALLBACK_CANCEL EINA_FALSE
+#define ECORE_CALLBACK_RENEW EINA_TRUE
+#define ECORE_CALLBACK_PASS_ON EINA_TRUE
+
+typedef Eina_Bool (*Ecore_Task_Cb) (void *data);
+typedef void (*Ecore_Cb) (void *data);
+
+typedef struct _Ecore_Idler Ecore_Idler;
+typedef struct _Ecore_Idler Ecore_Timer;
+typedef struct _Ecore_Idler Ecore_Job;
+typedef struct _Ecore_Idler Ecore_Animator;
+typedef struct _Ecore_Thread Ecore_Thread;
+
+typedef void (*Ecore_Thread_Cb) (void *data, Ecore_Thread *thread);
+
+/* events are never raised, handlers are only accepted */
+typedef struct _Ecore_Event_Handler Ecore_Event_Handler;
+typedef Eina_Bool (*Ecore_Event_Handler_Cb) (void *data, int type,
+					      void *event);
+
+typedef struct {
+	int number;
+} Ecore_Event_Signal_User;
+
+extern int ECORE_EVENT_SIGNAL_USER;
+
+Ecore_Idler *ecore_idler_add(Ecore_Task_Cb func, const void *data);
+void *ecore_idler_del(Ecore_Idler *idler);
+Ecore_Timer *ecore_timer_add(double in, Ecore_Task_Cb func, const void *data);
+void *ecore_timer_del(Ecore_Timer *timer);
+Ecore_Job *ecore_job_add(Ecore_Cb func, const void *data);
+void *ecore_job_del(Ecore_Job *job);
+/* every loop pass is a frame */
+Ecore_Animator *ecore_animator_add(Ecore_Task_Cb func, const void *data);
+void *ecore_animator_del(Ecore_Animator *animator);
+Ecore_Thread *ecore_thread_run(Ecore_Thread_Cb func_blocking,
+			       Ecore_Thread_Cb func_end,
+			       Ecore_Thread_Cb func_cancel, const void *data);
+double ecore_time_get(void);
+Ecore_Event_Handler *ecore_event_handler_add(int type,
+					     Ecore_Event_Handler_Cb func,
+					     const void *data);
+void *ecore_event_handler_del(Ecore_Event_Handler *handler);
+
+/* the manager emits indicator signals on the conformant */
+void elm_object_signal_emit(void *obj, const char *emission,
+			    const char *source);
+
+#endif				/* __BENCH_ECORE_H__ */
@@ -0,0 +1,48 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* ug-bench stand-in for Xlib: no X server, only what the manager uses */
+
+#ifndef __BENCH_XLIB_H__
+#define __BENCH_XLIB_H__
+
+typedef struct _XDisplay Display;
+typedef unsigned long Window;
+typedef unsigned long Atom;
+typedef int Bool;
+
+#define False 0
+#define True 1
+#define Success 0
+#define BadImplementation 17
+
+Window XDefaultRootWindow(Display *dpy);
+Atom XInternAtom(Display *dpy, const char *name, Bool only_if_exists);
+int XGetWindowProperty(Display *dpy, Window w, Atom property,
+		       long long_offset, long long_length, Bool delete,
+		       Atom req_type, Atom *actual_type_return,
+		       int *actual_format_return,
+		       unsigned long *nitems_return,
+		       unsigned long *bytes_after_return,
+		       unsigned char **prop_return);
+int XFree(void *data);
+
+#endif				/* __BENCH_XLIB_H__ */
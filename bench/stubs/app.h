@@ -0,0 +1,44 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* ug-bench stand-in for capi-appfw-application: service_h only */
+
+#ifndef __BENCH_APP_H__
+#define __BENCH_APP_H__
+
+#include <bundle.h>
+
+typedef struct service_s *service_h;
+
+typedef enum {
+	SERVICE_RESULT_SUCCEEDED = 0,
+	SERVICE_RESULT_FAILED = -1,
+	SERVICE_RESULT_CANCELED = -2,
+} service_result_e;
+
+int service_create(service_h *service);
+int service_clone(service_h *clone, service_h service);
+int service_destroy(service_h service);
+int service_add_extra_data(service_h service, const char *key,
+			   const char *value);
+int service_to_bundle(service_h service, bundle **data);
+
+#endif				/* __BENCH_APP_H__ */
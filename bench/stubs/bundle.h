@@ -0,0 +1,33 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* ug-bench stand-in for bundle */
+
+#ifndef __BENCH_BUNDLE_H__
+#define __BENCH_BUNDLE_H__
+
+typedef struct _bundle_t bundle;
+typedef void (*bundle_iterator_t) (const char *key, const char *val,
+				   void *data);
+
+void bundle_foreach(bundle *b, bundle_iterator_t iter, void *user_data);
+
+#endif				/* __BENCH_BUNDLE_H__ */
@@ -0,0 +1,34 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* ug-bench stand-in: logs are dropped, arguments are still checked */
+
+#ifndef __BENCH_DLOG_H__
+#define __BENCH_DLOG_H__
+
+#include <stdio.h>
+
+#define LOGE(fmt, arg...) do { if (0) printf(fmt, ##arg); } while (0)
+#define LOGW(fmt, arg...) do { if (0) printf(fmt, ##arg); } while (0)
+#define LOGI(fmt, arg...) do { if (0) printf(fmt, ##arg); } while (0)
+#define LOGD(fmt, arg...) do { if (0) printf(fmt, ##arg); } while (0)
+
+#endif				/* __BENCH_DLOG_H__ */
@@ -0,0 +1,32 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* ug-bench stand-in for utilX: there is no indicator */
+
+#ifndef __BENCH_UTILX_H__
+#define __BENCH_UTILX_H__
+
+#include <X11/Xlib.h>
+
+int utilx_get_indicator_state(Display *dpy, Window win);
+void utilx_enable_indicator(Display *dpy, Window win, int enable);
+
+#endif				/* __BENCH_UTILX_H__ */
@@ -0,0 +1,247 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * ug-bench-gen: writes the source of a synthetic gadget for ug-bench-load.
+ *
+ * Real gadgets differ in text size, relocation count, the libraries they
+ * pull in and how long their constructors and callbacks take; each of
+ * these is a knob here. The generated gadget depends on the bench-dep
+ * libraries for its DT_NEEDED fan-out.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct gen_opts {
+	unsigned int text_kb;
+	unsigned int relocs;
+	unsigned int needed;
+	unsigned int ctor_us;
+	unsigned int init_us;
+	unsigned int cb_us;
+	const char *out;
+};
+
+static void gen_params(FILE *fp, struct gen_opts *o)
+{
+	fprintf(fp, "BENCH_EXPORT const char bench_module_params[] =\n"
+		"\t\"{ \\\"text_kb\\\": %u, \\\"relocs\\\": %u, "
+		"\\\"needed\\\": %u, \"\n"
+		"\t\"\\\"ctor_us\\\": %u, \\\"init_us\\\": %u, "
+		"\\\"cb_us\\\": %u }\";\n\n",
+		o->text_kb, o->relocs, o->needed,
+		o->ctor_us, o->init_us, o->cb_us);
+}
+
+/*
+ * Every reloc slot points at a distinct default-visibility symbol, so
+ * each one is a symbol lookup at dlopen() time, not a RELATIVE fixup.
+ * The first "needed" slots point into the bench-dep libraries, which is
+ * what keeps them in DT_NEEDED.
+ */
+static void gen_relocs(FILE *fp, struct gen_opts *o)
+{
+	unsigned int i;
+
+	for (i = 0; i < o->needed; i++)
+		fprintf(fp, "extern void bench_dep_%u(void);\n", i);
+	for (i = o->needed; i < o->relocs; i++)
+		fprintf(fp, "BENCH_EXPORT int bench_sym_%u;\n", i);
+
+	fprintf(fp, "\nBENCH_EXPORT void *bench_relocs[] = {\n");
+	for (i = 0; i < o->needed; i++)
+		fprintf(fp, "\t(void *)bench_dep_%u,\n", i);
+	for (i = o->needed; i < o->relocs; i++)
+		fprintf(fp, "\t&bench_sym_%u,\n", i);
+	fprintf(fp, "\tNULL,\n};\n\n");
+}
+
+static void gen_text(FILE *fp, struct gen_opts *o)
+{
+	if (!o->text_kb)
+		return;
+
+	/* never executed, it only makes the text segment the given size */
+	fprintf(fp, "__asm__(\".pushsection .text\\n\"\n"
+		"\t\".balign 4096\\n\"\n"
+		"\t\".fill %u, 1, 0x90\\n\"\n"
+		"\t\".popsection\");\n\n", o->text_kb * 1024);
+}
+
+static void gen_body(FILE *fp, struct gen_opts *o)
+{
+	fprintf(fp,
+		"BENCH_EXPORT uint64_t bench_module_marks[BENCH_MARK_MAX];\n"
+		"\n"
+		"static void busy(unsigned int us)\n"
+		"{\n"
+		"\tuint64_t end = bench_now() + us * 1000ULL;\n"
+		"\n"
+		"\twhile (us && bench_now() < end)\n"
+		"\t\t;\n"
+		"}\n"
+		"\n"
+		"__attribute__ ((constructor)) static void ctor(void)\n"
+		"{\n"
+		"\tbench_module_marks[BENCH_MARK_CTOR_BEGIN] = bench_now();\n"
+		"\tbusy(%u);\n"
+		"\tbench_module_marks[BENCH_MARK_CTOR_END] = bench_now();\n"
+		"}\n"
+		"\n"
+		"static void *on_create(ui_gadget_h ug, enum ug_mode mode,\n"
+		"\t\t       service_h service, void *priv)\n"
+		"{\n"
+		"\tbusy(CB_US);\n"
+		"\treturn bench_relocs;\n"
+		"}\n"
+		"\n"
+		"static void on_cb(ui_gadget_h ug, service_h service, "
+		"void *priv)\n"
+		"{\n"
+		"\tbusy(CB_US);\n"
+		"}\n"
+		"\n"
+		"static void on_message(ui_gadget_h ug, service_h msg,\n"
+		"\t\t       service_h service, void *priv)\n"
+		"{\n"
+		"\tbusy(CB_US);\n"
+		"}\n"
+		"\n"
+		"static void on_event(ui_gadget_h ug, enum ug_event event,\n"
+		"\t\t     service_h service, void *priv)\n"
+		"{\n"
+		"\tbusy(CB_US);\n"
+		"}\n"
+		"\n"
+		"BENCH_EXPORT int UG_MODULE_INIT(struct ug_module_ops *ops)\n"
+		"{\n"
+		"\tbench_module_marks[BENCH_MARK_INIT_BEGIN] = bench_now();\n"
+		"\tbusy(%u);\n"
+		"\n"
+		"\tops->create = on_create;\n"
+		"\tops->start = on_cb;\n"
+		"\tops->pause = on_cb;\n"
+		"\tops->resume = on_cb;\n"
+		"\tops->destroy = on_cb;\n"
+		"\tops->message = on_message;\n"
+		"\tops->event = on_event;\n"
+		"\tops->opt = UG_OPT_INDICATOR_ENABLE;\n"
+		"\n"
+		"\tbench_module_marks[BENCH_MARK_INIT_END] = bench_now();\n"
+		"\treturn 0;\n"
+		"}\n"
+		"\n"
+		"BENCH_EXPORT void UG_MODULE_EXIT(struct ug_module_ops *ops)\n"
+		"{\n"
+		"}\n",
+		o->ctor_us, o->init_us);
+}
+
+static int gen(struct gen_opts *o)
+{
+	FILE *fp;
+
+	fp = fopen(o->out, "w");
+	if (!fp) {
+		perror(o->out);
+		return -1;
+	}
+
+	fprintf(fp, "/* generated by ug-bench-gen, do not edit */\n\n"
+		"#include <stdint.h>\n"
+		"#include <stddef.h>\n"
+		"\n"
+		"#include <ui-gadget-module.h>\n"
+		"\n"
+		"#include \"bench.h\"\n"
+		"\n"
+		"#define BENCH_EXPORT __attribute__ ((visibility(\"default\")))\n"
+		"#define CB_US %u\n\n", o->cb_us);
+
+	gen_params(fp, o);
+	gen_relocs(fp, o);
+	gen_text(fp, o);
+	gen_body(fp, o);
+
+	if (fclose(fp)) {
+		perror(o->out);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void usage(void)
+{
+	printf("Usage: ug-bench-gen -o FILE [-t TEXT_KB] [-r RELOCS] "
+	       "[-n NEEDED] [-c CTOR_US] [-i INIT_US] [-b CALLBACK_US]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct gen_opts o;
+	int opt;
+
+	memset(&o, 0, sizeof(o));
+
+	while ((opt = getopt(argc, argv, "o:t:r:n:c:i:b:h")) != -1) {
+		switch (opt) {
+		case 'o':
+			o.out = optarg;
+			break;
+		case 't':
+			o.text_kb = strtoul(optarg, NULL, 10);
+			break;
+		case 'r':
+			o.relocs = strtoul(optarg, NULL, 10);
+			break;
+		case 'n':
+			o.needed = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			o.ctor_us = strtoul(optarg, NULL, 10);
+			break;
+		case 'i':
+			o.init_us = strtoul(optarg, NULL, 10);
+			break;
+		case 'b':
+			o.cb_us = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			usage();
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (!o.out) {
+		usage();
+		return 1;
+	}
+
+	/* the DT_NEEDED references are relocations too */
+	if (o.relocs < o.needed)
+		o.relocs = o.needed;
+
+	return gen(&o) ? 1 : 0;
+}
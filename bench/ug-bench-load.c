@@ -0,0 +1,327 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * ug-bench-load: where the time of loading a gadget goes.
+ *
+ * Loads the synthetic gadgets made by ug-bench-gen through
+ * ug_module_load() and ug_module_unload(), once with the page cache
+ * dropped for the benchmark's libraries (cold) and once with it populated
+ * (warm), and splits each load with the timestamps the gadget records.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <dlfcn.h>
+
+#include <ui-gadget.h>
+
+#include "ug-module.h"
+#include "bench.h"
+
+enum bench_phase {
+	/* path lookup, mapping, DT_NEEDED and relocation */
+	BENCH_PHASE_MAP,
+	BENCH_PHASE_CTOR,
+	/* dlsym() of the entry points and registry bookkeeping */
+	BENCH_PHASE_SYMBOLS,
+	BENCH_PHASE_INIT,
+	BENCH_PHASE_LOAD,
+	BENCH_PHASE_CREATE,
+	BENCH_PHASE_DESTROY,
+	BENCH_PHASE_UNLOAD,
+	BENCH_PHASE_MAX,
+};
+
+static const char *bench_phase_names[BENCH_PHASE_MAX] = {
+	"map",
+	"ctor",
+	"symbols",
+	"init",
+	"load",
+	"create",
+	"destroy",
+	"unload",
+};
+
+struct bench_run {
+	const char *module;
+	const char *cache;
+	char *names[BENCH_PHASE_MAX];
+	struct bench_samples phases[BENCH_PHASE_MAX];
+};
+
+/* drops the page cache of every gadget and library in the module dir */
+static void bench_evict(void)
+{
+	char path[4096];
+	struct dirent *d;
+	DIR *dir;
+	int fd;
+
+	dir = opendir(BENCH_MODULE_DIR);
+	if (!dir)
+		return;
+
+	while ((d = readdir(dir))) {
+		if (strncmp(d->d_name, "libug-bench-", 12))
+			continue;
+
+		snprintf(path, sizeof(path), "%s/%s", BENCH_MODULE_DIR,
+			 d->d_name);
+		fd = open(path, O_RDONLY);
+		if (fd < 0)
+			continue;
+
+		/* dirty pages are not dropped, freshly linked files are */
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+
+	closedir(dir);
+}
+
+static int bench_run_init(struct bench_run *r, const char *module,
+			  const char *cache, unsigned int iterations)
+{
+	int i;
+
+	r->module = module;
+	r->cache = cache;
+
+	for (i = 0; i < BENCH_PHASE_MAX; i++) {
+		if (asprintf(&r->names[i], "%s/%s/%s", module, cache,
+			     bench_phase_names[i]) < 0)
+			return -1;
+		if (bench_samples_init(&r->phases[i], r->names[i],
+				       iterations))
+			return -1;
+	}
+
+	return 0;
+}
+
+static void bench_run_free(struct bench_run *r)
+{
+	int i;
+
+	for (i = 0; i < BENCH_PHASE_MAX; i++) {
+		bench_samples_free(&r->phases[i]);
+		free(r->names[i]);
+	}
+}
+
+static void bench_run_report(FILE *fp, struct bench_run *r,
+			     const char *params)
+{
+	int i;
+
+	for (i = 0; i < BENCH_PHASE_MAX; i++)
+		bench_report_samples(fp, &r->phases[i], params);
+}
+
+static int bench_load_once(struct bench_run *r)
+{
+	struct ug_module *m;
+	uint64_t *marks;
+	uint64_t t0;
+	uint64_t t;
+	void *layout;
+
+	t0 = bench_now();
+	m = ug_module_load(r->module);
+	t = bench_now();
+	if (!m) {
+		fprintf(stderr, "ug-bench-load: cannot load %s\n", r->module);
+		return -1;
+	}
+
+	marks = dlsym(m->handle, BENCH_MARKS_SYM);
+	if (!marks || marks[BENCH_MARK_CTOR_BEGIN] < t0) {
+		fprintf(stderr, "ug-bench-load: %s was not reloaded, "
+			"is it a ug-bench-gen gadget?\n", r->module);
+		ug_module_unload(m);
+		return -1;
+	}
+
+	bench_samples_add(&r->phases[BENCH_PHASE_MAP],
+			  marks[BENCH_MARK_CTOR_BEGIN] - t0);
+	bench_samples_add(&r->phases[BENCH_PHASE_CTOR],
+			  marks[BENCH_MARK_CTOR_END] -
+			  marks[BENCH_MARK_CTOR_BEGIN]);
+	bench_samples_add(&r->phases[BENCH_PHASE_SYMBOLS],
+			  marks[BENCH_MARK_INIT_BEGIN] -
+			  marks[BENCH_MARK_CTOR_END]);
+	bench_samples_add(&r->phases[BENCH_PHASE_INIT],
+			  marks[BENCH_MARK_INIT_END] -
+			  marks[BENCH_MARK_INIT_BEGIN]);
+	bench_samples_add(&r->phases[BENCH_PHASE_LOAD], t - t0);
+
+	t0 = bench_now();
+	layout = m->ops.create(NULL, UG_MODE_FULLVIEW, NULL, m->ops.priv);
+	bench_samples_add(&r->phases[BENCH_PHASE_CREATE], bench_now() - t0);
+
+	t0 = bench_now();
+	if (layout)
+		m->ops.destroy(NULL, NULL, m->ops.priv);
+	bench_samples_add(&r->phases[BENCH_PHASE_DESTROY], bench_now() - t0);
+
+	/* no grace period: this dlclose()s */
+	t0 = bench_now();
+	ug_module_unload(m);
+	bench_samples_add(&r->phases[BENCH_PHASE_UNLOAD], bench_now() - t0);
+
+	return 0;
+}
+
+static int bench_module(FILE *fp, const char *module, unsigned int iterations)
+{
+	struct bench_run cold;
+	struct bench_run warm;
+	const char *params = "{}";
+	struct ug_module *m;
+	unsigned int i;
+	int r = -1;
+
+	memset(&cold, 0, sizeof(cold));
+	memset(&warm, 0, sizeof(warm));
+	if (bench_run_init(&cold, module, "cold", iterations) ||
+	    bench_run_init(&warm, module, "warm", iterations)) {
+		fprintf(stderr, "ug-bench-load: out of memory\n");
+		goto out;
+	}
+
+	for (i = 0; i < iterations; i++) {
+		bench_evict();
+		if (bench_load_once(&cold))
+			goto out;
+	}
+
+	/* populates the page cache again */
+	m = ug_module_load(module);
+	if (!m)
+		goto out;
+	ug_module_unload(m);
+
+	for (i = 0; i < iterations; i++) {
+		if (bench_load_once(&warm))
+			goto out;
+	}
+
+	/* the parameters live in the gadget, read them while it is mapped */
+	m = ug_module_load(module);
+	if (m)
+		params = dlsym(m->handle, BENCH_PARAMS_SYM);
+	if (!params)
+		params = "{}";
+
+	bench_run_report(fp, &cold, params);
+	bench_run_report(fp, &warm, params);
+
+	if (m)
+		ug_module_unload(m);
+
+	r = 0;
+
+ out:
+	bench_run_free(&cold);
+	bench_run_free(&warm);
+	return r;
+}
+
+static void usage(void)
+{
+	printf("Usage: ug-bench-load [-n ITERATIONS] [-o FILE] [GADGET...]\n"
+	       "Default gadgets: %s\n", BENCH_LOAD_MODULES);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int iterations = 50;
+	const char *out = NULL;
+	char defaults[] = BENCH_LOAD_MODULES;
+	char *module;
+	char *save;
+	FILE *fp = stdout;
+	int opt;
+	int r = 0;
+
+	while ((opt = getopt(argc, argv, "n:o:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			iterations = strtoul(optarg, NULL, 10);
+			break;
+		case 'o':
+			out = optarg;
+			break;
+		default:
+			usage();
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (!iterations) {
+		usage();
+		return 1;
+	}
+
+	setenv("UG_MODULE_PATH", BENCH_MODULE_DIR, 0);
+	/* every iteration must pay for the dlopen() it measures */
+	setenv("UG_MODULE_GRACE", "0", 1);
+	ug_set_log_level(UG_LOG_LEVEL_NONE);
+
+	if (ug_module_init()) {
+		fprintf(stderr, "ug-bench-load: ug_module_init failed\n");
+		return 1;
+	}
+
+	if (out) {
+		fp = fopen(out, "w");
+		if (!fp) {
+			perror(out);
+			return 1;
+		}
+	}
+
+	bench_report_begin(fp, "ug-bench-load");
+
+	if (optind < argc) {
+		for (; optind < argc && !r; optind++)
+			r = bench_module(fp, argv[optind], iterations);
+	} else {
+		module = strtok_r(defaults, ",", &save);
+		for (; module && !r; module = strtok_r(NULL, ",", &save))
+			r = bench_module(fp, module, iterations);
+	}
+
+	bench_report_end(fp);
+
+	if (fp != stdout)
+		fclose(fp);
+
+	return r ? 1 : 0;
+}
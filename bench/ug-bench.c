@@ -0,0 +1,391 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * ug-bench: headless lifecycle throughput of ui-gadget-1.
+ *
+ * The library sources are linked against the stand-ins in stubs/ and
+ * drive the bench-null gadget. There is no engine, so gadgets are never
+ * shown: what is measured is the manager, the module registry and the
+ * gadget tree. Results are written as JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ui-gadget.h>
+
+#include "ug.h"
+#include "ug-manager.h"
+#include "bench.h"
+
+#define BENCH_UG "bench-null"
+
+struct bench_opts {
+	unsigned int iterations;
+	unsigned int depth;
+	unsigned int fanout;
+	unsigned int gadgets;
+	const char *out;
+};
+
+static int bench_results;
+
+static void result_cb(ui_gadget_h ug, service_h result, void *priv)
+{
+	bench_results++;
+}
+
+static struct ug_cbs bench_cbs = {
+	.result_cb = result_cb,
+};
+
+static ui_gadget_h bench_create(ui_gadget_h parent)
+{
+	ui_gadget_h ug;
+
+	ug = ug_create(parent, BENCH_UG, UG_MODE_FRAMEVIEW, NULL, &bench_cbs);
+	if (!ug) {
+		fprintf(stderr, "ug-bench: ug_create(%s) failed\n", BENCH_UG);
+		exit(1);
+	}
+
+	return ug;
+}
+
+static void bench_destroy_all(void)
+{
+	ug_destroy_all();
+	bench_loop_run();
+}
+
+/* full tree of the given depth and fan-out, returns the gadget count */
+static unsigned int bench_tree(ui_gadget_h parent, unsigned int depth,
+			       unsigned int fanout)
+{
+	unsigned int n = 0;
+	unsigned int i;
+	ui_gadget_h ug;
+
+	if (!depth)
+		return 0;
+
+	for (i = 0; i < fanout; i++) {
+		ug = bench_create(parent);
+		n += 1 + bench_tree(ug, depth - 1, fanout);
+	}
+
+	return n;
+}
+
+static ui_gadget_h bench_flat(unsigned int count)
+{
+	ui_gadget_h ug = NULL;
+	unsigned int i;
+
+	for (i = 0; i < count; i++)
+		ug = bench_create(NULL);
+
+	return ug;
+}
+
+static void bench_lifecycle(FILE *fp, struct bench_opts *o)
+{
+	struct bench_samples s;
+	ui_gadget_h ug;
+	uint64_t t;
+	unsigned int i;
+
+	bench_samples_init(&s, "create_destroy", o->iterations);
+
+	for (i = 0; i < o->iterations; i++) {
+		t = bench_now();
+		ug = bench_create(NULL);
+		ug_destroy(ug);
+		bench_loop_run();
+		bench_samples_add(&s, bench_now() - t);
+	}
+
+	bench_report_samples(fp, &s, "{}");
+	bench_samples_free(&s);
+}
+
+static void bench_nested(FILE *fp, struct bench_opts *o)
+{
+	struct bench_samples create;
+	struct bench_samples destroy;
+	unsigned int n = 0;
+	unsigned int i;
+	uint64_t t;
+	char params[96];
+
+	bench_samples_init(&create, "tree_create", o->iterations);
+	bench_samples_init(&destroy, "tree_destroy_all", o->iterations);
+
+	for (i = 0; i < o->iterations; i++) {
+		t = bench_now();
+		n = bench_tree(NULL, o->depth, o->fanout);
+		bench_samples_add(&create, bench_now() - t);
+
+		t = bench_now();
+		bench_destroy_all();
+		bench_samples_add(&destroy, bench_now() - t);
+	}
+
+	snprintf(params, sizeof(params),
+		 "{ \"depth\": %u, \"fanout\": %u, \"gadgets\": %u }",
+		 o->depth, o->fanout, n);
+	bench_report_samples(fp, &create, params);
+	bench_report_samples(fp, &destroy, params);
+	bench_samples_free(&create);
+	bench_samples_free(&destroy);
+}
+
+static void bench_event(FILE *fp, struct bench_opts *o)
+{
+	struct bench_samples s;
+	struct bench_samples burst;
+	struct bench_samples pruned;
+	unsigned int i;
+	uint64_t t;
+	char params[64];
+
+	bench_samples_init(&s, "event_broadcast", o->iterations);
+	bench_samples_init(&burst, "event_burst", o->iterations);
+	bench_samples_init(&pruned, "event_unsubscribed", o->iterations);
+	bench_flat(o->gadgets);
+	bench_loop_run();
+
+	for (i = 0; i < o->iterations; i++) {
+		t = bench_now();
+		ug_send_event(UG_EVENT_LOW_BATTERY);
+		bench_loop_run();
+		bench_samples_add(&s, bench_now() - t);
+	}
+
+	/* a window manager rotating back and forth, and a repeated event */
+	for (i = 0; i < o->iterations; i++) {
+		t = bench_now();
+		ug_send_event(UG_EVENT_ROTATE_LANDSCAPE);
+		ug_send_event(UG_EVENT_ROTATE_PORTRAIT);
+		ug_send_event(UG_EVENT_ROTATE_LANDSCAPE);
+		ug_send_event(UG_EVENT_LANG_CHANGE);
+		ug_send_event(UG_EVENT_LANG_CHANGE);
+		bench_loop_run();
+		bench_samples_add(&burst, bench_now() - t);
+	}
+
+	/* bench-null does not take REGION_CHANGE, no gadget is visited */
+	for (i = 0; i < o->iterations; i++) {
+		t = bench_now();
+		ug_send_event(UG_EVENT_REGION_CHANGE);
+		bench_loop_run();
+		bench_samples_add(&pruned, bench_now() - t);
+	}
+
+	bench_destroy_all();
+
+	snprintf(params, sizeof(params), "{ \"gadgets\": %u }", o->gadgets);
+	bench_report_samples(fp, &s, params);
+	bench_report_samples(fp, &burst, params);
+	bench_report_samples(fp, &pruned, params);
+	bench_samples_free(&s);
+	bench_samples_free(&burst);
+	bench_samples_free(&pruned);
+}
+
+static void bench_message(FILE *fp, struct bench_opts *o)
+{
+	struct bench_samples s;
+	service_h msg;
+	ui_gadget_h ug;
+	unsigned int i;
+	uint64_t t;
+
+	bench_samples_init(&s, "message_round_trip", o->iterations);
+	service_create(&msg);
+	ug = bench_create(NULL);
+
+	for (i = 0; i < o->iterations; i++) {
+		bench_results = 0;
+		t = bench_now();
+		ug_send_message(ug, msg);
+		bench_samples_add(&s, bench_now() - t);
+		if (bench_results != 1) {
+			fprintf(stderr, "ug-bench: message was not answered\n");
+			exit(1);
+		}
+	}
+
+	bench_destroy_all();
+	service_destroy(msg);
+
+	bench_report_samples(fp, &s, "{}");
+	bench_samples_free(&s);
+}
+
+/* an app going to background right after it came back */
+static void bench_pause_resume(FILE *fp, struct bench_opts *o)
+{
+	struct bench_samples s;
+	ui_gadget_h ug;
+	unsigned int i;
+	uint64_t t;
+
+	bench_samples_init(&s, "resume_then_pause", o->iterations);
+	ug = bench_create(NULL);
+	bench_loop_run();
+	ug_pause();
+	bench_loop_run();
+
+	for (i = 0; i < o->iterations; i++) {
+		t = bench_now();
+		ug_resume();
+		ug_pause();
+		bench_loop_run();
+		bench_samples_add(&s, bench_now() - t);
+		if (ug->state != UG_STATE_STOPPED) {
+			fprintf(stderr, "ug-bench: gadget is not paused, "
+				"state(%d)\n", ug->state);
+			exit(1);
+		}
+	}
+
+	bench_destroy_all();
+
+	bench_report_samples(fp, &s, "{}");
+	bench_samples_free(&s);
+}
+
+#define BENCH_EXIST_BATCH 1000
+
+static void bench_exist(FILE *fp, struct bench_opts *o)
+{
+	struct bench_samples s;
+	ui_gadget_h ug;
+	unsigned int i;
+	unsigned int j;
+	uint64_t t;
+	char params[96];
+
+	bench_samples_init(&s, "ugman_ug_exist", o->iterations);
+	ug = bench_flat(o->gadgets);
+
+	/* batched: a single call is below the clock resolution */
+	for (i = 0; i < o->iterations; i++) {
+		t = bench_now();
+		for (j = 0; j < BENCH_EXIST_BATCH; j++) {
+			if (!ugman_ug_exist(ug)) {
+				fprintf(stderr, "ug-bench: gadget is lost\n");
+				exit(1);
+			}
+		}
+		bench_samples_add(&s, (bench_now() - t) / BENCH_EXIST_BATCH);
+	}
+
+	bench_destroy_all();
+
+	snprintf(params, sizeof(params),
+		 "{ \"gadgets\": %u, \"batch\": %u }",
+		 o->gadgets, BENCH_EXIST_BATCH);
+	bench_report_samples(fp, &s, params);
+	bench_samples_free(&s);
+}
+
+static void usage(void)
+{
+	printf("Usage: ug-bench [-n ITERATIONS] [-d DEPTH] [-f FANOUT] "
+	       "[-g GADGETS] [-o FILE]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct bench_opts o = {
+		.iterations = 1000,
+		.depth = 3,
+		.fanout = 4,
+		.gadgets = 256,
+		.out = NULL,
+	};
+	FILE *fp = stdout;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:d:f:g:o:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			o.iterations = strtoul(optarg, NULL, 10);
+			break;
+		case 'd':
+			o.depth = strtoul(optarg, NULL, 10);
+			break;
+		case 'f':
+			o.fanout = strtoul(optarg, NULL, 10);
+			break;
+		case 'g':
+			o.gadgets = strtoul(optarg, NULL, 10);
+			break;
+		case 'o':
+			o.out = optarg;
+			break;
+		default:
+			usage();
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (!o.iterations || !o.gadgets) {
+		usage();
+		return 1;
+	}
+
+	/* the gadget is built next to the benchmark */
+	setenv("UG_MODULE_PATH", BENCH_MODULE_DIR, 0);
+	setenv("UG_LOG_LEVEL", "none", 0);
+
+	if (ug_init((Display *)1, 1, (void *)1, UG_OPT_INDICATOR_ENABLE)) {
+		fprintf(stderr, "ug-bench: ug_init failed\n");
+		return 1;
+	}
+
+	if (o.out) {
+		fp = fopen(o.out, "w");
+		if (!fp) {
+			perror(o.out);
+			return 1;
+		}
+	}
+
+	bench_report_begin(fp, "ug-bench");
+	bench_lifecycle(fp, &o);
+	bench_nested(fp, &o);
+	bench_event(fp, &o);
+	bench_message(fp, &o);
+	bench_pause_resume(fp, &o);
+	bench_exist(fp, &o);
+	bench_report_end(fp);
+
+	if (fp != stdout)
+		fclose(fp);
+
+	return 0;
+}
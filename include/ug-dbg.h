@@ -23,6 +23,7 @@
 #define __UG_DBG_H__
 
 #include <dlog.h>
+#include "ui-gadget.h"
 
 #ifdef LOG_TAG
 #undef LOG_TAG
@@ -30,9 +31,26 @@
 
 #define LOG_TAG "UI_GADGET"
 
-#define _ERR(fmt, arg...) LOGE("\x1b[31m" fmt "\x1b[0m", ##arg)
-#define _DBG(fmt, arg...) LOGD("\x1b[32m" fmt "\x1b[0m", ##arg)
-#define _INFO(fmt, arg...) LOGI("\x1b[33m" fmt "\x1b[0m", ##arg)
-#define _WRN(fmt, arg...) LOGW("\x1b[34m" fmt "\x1b[0m", ##arg)
+/* runtime level, see ug_set_log_level() and UG_LOG_LEVEL */
+extern int ug_log_level;
+
+/* the level is checked before any argument is evaluated */
+#define UG_LOG(level, log, fmt, arg...) \
+	do { \
+		if (ug_log_level >= (level)) \
+			log(fmt, ##arg); \
+	} while (0)
+
+#define _ERR(fmt, arg...) UG_LOG(UG_LOG_LEVEL_ERROR, LOGE, "\x1b[31m" fmt "\x1b[0m", ##arg)
+#define _WRN(fmt, arg...) UG_LOG(UG_LOG_LEVEL_WARN, LOGW, "\x1b[34m" fmt "\x1b[0m", ##arg)
+
+#ifdef UG_DISABLE_DEBUG_LOG
+/* compiled out, but arguments are still type checked */
+#define _DBG(fmt, arg...) do { if (0) LOGD(fmt, ##arg); } while (0)
+#define _INFO(fmt, arg...) do { if (0) LOGI(fmt, ##arg); } while (0)
+#else
+#define _DBG(fmt, arg...) UG_LOG(UG_LOG_LEVEL_DEBUG, LOGD, "\x1b[32m" fmt "\x1b[0m", ##arg)
+#define _INFO(fmt, arg...) UG_LOG(UG_LOG_LEVEL_INFO, LOGI, "\x1b[33m" fmt "\x1b[0m", ##arg)
+#endif
 
 #endif				/* __UG_DBG_H__ */
@@ -0,0 +1,174 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_FLIGHT_H__
+#define __UG_FLIGHT_H__
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Flight recorder: an always-on ring of the last UG_FLIGHT_ENTRIES
+ * lifecycle events, written without locks from the manager and the
+ * engine. On SIGSEGV, SIGBUS or SIGABRT it is dumped, with async-signal-
+ * safe calls only, to "<UG_FLIGHT_FILE>.<pid>" ("/tmp/ug-flight-<pid>.bin"
+ * without it), and the ug-flight tool decodes the dump. The dump is only
+ * written to a file it creates itself: when the path is taken, by an
+ * earlier process with the same pid or anyone else, it goes to the path
+ * with ".1" to ".9" appended, and nothing is ever removed.
+ *
+ * Only signals the app leaves at their default action are caught, and
+ * the signal then takes that action. UG_FLIGHT=1 also dumps ahead of
+ * the app's own handlers, which get the signal afterwards, and
+ * UG_FLIGHT=0 turns the recorder off. The thread that called ug_init()
+ * gets a signal stack if it has none; a stack overflow on any other
+ * thread is not dumped.
+ *
+ * Dump layout:
+ *   struct ug_flight_header
+ *   struct ug_flight_entry  entries[n_entries]   (ring order, see seq)
+ *   char                    names[n_names][UG_FLIGHT_NAME_LEN]
+ */
+
+#define UG_FLIGHT_MAGIC 0x52464755	/* "UGFR" */
+#define UG_FLIGHT_VERSION 1
+
+/* both powers of two */
+#define UG_FLIGHT_ENTRIES 1024
+#define UG_FLIGHT_NAMES 128
+#define UG_FLIGHT_NAME_LEN 64
+
+/*
+ * Entry ops: 0 .. UG_OP_MAX - 1 are calls into module operations (see
+ * enum ug_op), with UG_FLIGHT_LEAVE or'ed in when they return.
+ */
+enum ug_flight_op {
+	UG_FLIGHT_OP_STATE = 0x20,	/* gadget state change */
+	UG_FLIGHT_OP_LAYOUT,		/* engine layout state change */
+	UG_FLIGHT_OP_LOAD,		/* ug_create() */
+	UG_FLIGHT_OP_DEL,		/* ug_destroy() */
+};
+
+#define UG_FLIGHT_LEAVE 0x80
+
+struct ug_flight_entry {
+	uint64_t ticks;		/* see ug_flight_header for the clock */
+	uint64_t ug;
+	uint32_t seq;		/* event number + 1, 0: being written */
+	uint32_t name;		/* index into names, 0: none */
+	uint8_t op;
+	uint8_t state_old;
+	uint8_t state_new;
+	uint8_t layout_old;
+	uint8_t layout_new;
+	uint8_t reserved[3];
+};
+
+struct ug_flight_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_size;
+	uint32_t n_entries;
+	uint32_t n_names;
+	uint32_t name_len;
+	uint32_t head;		/* events recorded so far */
+	int32_t pid;
+	int32_t signo;
+	uint32_t reserved;
+	/* ticks and CLOCK_MONOTONIC ns at start and at the dump */
+	uint64_t ticks_start;
+	uint64_t mono_start;
+	uint64_t ticks_dump;
+	uint64_t mono_dump;
+};
+
+struct ug_flight {
+	int enabled;
+	uint32_t head;
+	/* 32-bit ARM: the generic timer's virtual counter can be read */
+	int cntvct;
+	struct ug_flight_entry ring[UG_FLIGHT_ENTRIES];
+};
+
+/* UG_INTERNAL_API, for the engine */
+extern struct ug_flight ug_flight;
+
+/*
+ * The cheapest monotonic counter at hand, converted at decode time: the
+ * TSC on x86 and the generic timer on ARM, a few ns to read. 32-bit ARM
+ * cores without the generic timer (Cortex-A9 and older), or kernels that
+ * keep it from user space, fall back to clock_gettime(): a vDSO call of
+ * some 100 ns, a system call of about 1 us on kernels without the vDSO.
+ */
+static inline uint64_t ug_flight_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+	uint64_t v;
+
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r" (v));
+	return v;
+#else
+	struct timespec ts;
+#if defined(__arm__) && defined(__ARM_ARCH) && __ARM_ARCH >= 7
+	uint64_t v;
+
+	if (ug_flight.cntvct) {
+		__asm__ __volatile__("mrrc p15, 1, %Q0, %R0, c14" : "=r" (v));
+		return v;
+	}
+#endif
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline void ug_flight_record(const void *ug, uint32_t name,
+				    unsigned int op,
+				    int state_old, int state_new,
+				    int layout_old, int layout_new)
+{
+	struct ug_flight_entry *e;
+	uint32_t seq;
+
+	if (!ug_flight.enabled)
+		return;
+
+	seq = __atomic_fetch_add(&ug_flight.head, 1, __ATOMIC_RELAXED);
+	e = &ug_flight.ring[seq & (UG_FLIGHT_ENTRIES - 1)];
+
+	__atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+	e->ticks = ug_flight_ticks();
+	e->ug = (uintptr_t)ug;
+	e->name = name;
+	e->op = op;
+	e->state_old = state_old;
+	e->state_new = state_new;
+	e->layout_old = layout_old;
+	e->layout_new = layout_new;
+	__atomic_store_n(&e->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+int ug_flight_init(void);
+uint32_t ug_flight_name(const char *name);
+
+#endif				/* __UG_FLIGHT_H__ */
@@ -0,0 +1,102 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_INDEX_H__
+#define __UG_INDEX_H__
+
+#include <stdint.h>
+
+/*
+ * Gadget index: a read-only file, written by the ug-index tool at install
+ * time, which maps a gadget name to its library path. The library mmaps it
+ * at ug_init() and checks the directories it covers. A lookup then costs
+ * a hash probe and a stat() of the library, whose size and mtime must
+ * still match the entry; the resolved path is cached by the caller.
+ *
+ * Layout (all offsets are from the start of the file):
+ *   struct ug_index_header
+ *   struct ug_index_dir    dirs[n_dirs]
+ *   uint32_t               buckets[n_buckets]  (entry index + 1, 0: empty)
+ *   struct ug_index_entry  entries[n_entries]
+ *   char                   strings[]           (string offsets are from
+ *                                               strings_off, 0 is "")
+ */
+
+#define UG_INDEX_FILE "/opt/usr/ug/.ug-index"
+#define UG_INDEX_MAGIC 0x58444755	/* "UGDX" */
+#define UG_INDEX_VERSION 1
+
+/* gadget library lookup order: caller package first, then shared dirs */
+#define UG_INDEX_PKG_ROOTS { "/usr/apps", "/opt/apps" }
+#define UG_INDEX_LIB_DIRS { "/usr/ug/lib", "/opt/ug/lib", "/opt/usr/ug/lib" }
+
+#define UG_INDEX_LIB_PREFIX "libug-"
+#define UG_INDEX_LIB_SUFFIX ".so"
+
+struct ug_index_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+	uint32_t n_dirs;
+	uint32_t n_buckets;
+	uint32_t n_entries;
+	uint32_t dirs_off;
+	uint32_t buckets_off;
+	uint32_t entries_off;
+	uint32_t strings_off;
+};
+
+/* every scanned directory, used to detect a stale index */
+struct ug_index_dir {
+	uint32_t path;
+	uint32_t pkg;		/* 0: shared directory */
+	int64_t mtime;		/* ns, -1: directory did not exist */
+};
+
+struct ug_index_entry {
+	uint32_t hash;
+	uint32_t next;		/* entry index + 1 in the same bucket */
+	uint32_t name;
+	uint32_t path;
+	uint32_t pkg;		/* 0: shared gadget */
+	uint32_t rank;		/* position in the lookup order */
+	uint64_t size;
+	int64_t mtime;		/* ns */
+};
+
+static inline uint32_t ug_index_hash(const char *name)
+{
+	uint32_t h = 2166136261u;
+
+	while (*name) {
+		h ^= (unsigned char)*name++;
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+int ug_index_open(const char *path, const char *pkg_name);
+void ug_index_close(void);
+/* 1: *path is set, 0: not indexed, -1: no index or the entry is stale */
+int ug_index_lookup(const char *name, const char **path);
+
+#endif				/* __UG_INDEX_H__ */
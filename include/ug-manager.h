@@ -31,6 +31,11 @@ ui_gadget_h ugman_ug_load(ui_gadget_h parent,
 				enum ug_mode mode,
 				service_h service,
 				struct ug_cbs *cbs);
+int ugman_ug_load_async(ui_gadget_h parent,
+				const char *name,
+				enum ug_mode mode,
+				service_h service,
+				struct ug_cbs *cbs);
 int ugman_ug_del(ui_gadget_h ug);
 int ugman_ug_del_all(void);
 
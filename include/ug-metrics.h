@@ -0,0 +1,156 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_METRICS_H__
+#define __UG_METRICS_H__
+
+#include <stdint.h>
+
+/*
+ * Live counters of a process, kept private unless UG_METRICS=1 publishes
+ * them in the shared memory object UG_METRICS_SHM
+ * ("/dev/shm/ug-metrics.<pid>") for ug-top to read. Writers use relaxed
+ * atomics, readers take whatever they see. The object is removed at exit,
+ * and by ug-top once its process is gone without exiting.
+ *
+ * The gadget tree is mirrored into nodes[]: a slot is in use while ug is
+ * not 0, and children point at their parent's ug.
+ *
+ * Deferred jobs (ug-sched.h) are counted per job type in jobs[], with the
+ * time from being queued to running in power-of-two histograms. Jobs
+ * later than UG_IDLER_LAG_MS, when set at ug_init(), are logged.
+ */
+
+#define UG_METRICS_MAGIC 0x4d544755	/* "UGTM" */
+#define UG_METRICS_VERSION 3
+#define UG_METRICS_SHM "/ug-metrics.%d"
+
+/* at least UG_STATE_MAX */
+#define UG_METRICS_STATES 8
+#define UG_METRICS_NODES 256
+#define UG_METRICS_NAME_LEN 48
+#define UG_METRICS_JOBS 16
+#define UG_METRICS_JOB_NAME_LEN 24
+
+/* bucket i counts lags of [2^i, 2^(i+1)) us, bucket 0 those under 2 us */
+#define UG_METRICS_LAG_BUCKETS 24
+
+struct ug_metrics_node {
+	uint64_t ug;		/* 0: free slot */
+	uint64_t parent;
+	char name[UG_METRICS_NAME_LEN];
+	uint8_t state;
+	uint8_t layout;
+	uint8_t mode;
+	uint8_t reserved[5];
+};
+
+struct ug_metrics_job {
+	char name[UG_METRICS_JOB_NAME_LEN];	/* "": free slot */
+	int64_t queued;		/* queued and not run yet */
+	uint64_t runs;		/* first runs, renewed runs are not lag */
+	uint64_t late;		/* over UG_IDLER_LAG_MS */
+	uint64_t lag_sum;	/* ns */
+	uint64_t lag_max;	/* ns */
+	uint64_t lag_hist[UG_METRICS_LAG_BUCKETS];
+};
+
+struct ug_metrics {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+	int32_t pid;
+
+	/* gauges: gadgets alive by enum ug_state, deferred jobs not done yet */
+	int64_t alive[UG_METRICS_STATES];
+	int64_t idlers;
+	/* gadget libraries kept loaded by the module registry */
+	int64_t modules_resident;
+
+	/* counters */
+	uint64_t creates;
+	uint64_t destroys;
+	uint64_t module_hits;
+	uint64_t module_misses;
+	uint64_t idlers_run;
+	uint64_t events;
+	uint64_t key_events;
+	uint64_t messages;
+	uint64_t message_bytes;
+	uint64_t results;
+	uint64_t result_bytes;
+	uint64_t nodes_dropped;	/* gadgets beyond UG_METRICS_NODES */
+
+	struct ug_metrics_job jobs[UG_METRICS_JOBS];
+	struct ug_metrics_node nodes[UG_METRICS_NODES];
+};
+
+/* UG_INTERNAL_API, for the engine; never NULL */
+extern struct ug_metrics *ug_metrics;
+
+#define UG_METRICS_ADD(field, n) \
+	__atomic_fetch_add(&ug_metrics->field, (n), __ATOMIC_RELAXED)
+#define UG_METRICS_INC(field) UG_METRICS_ADD(field, 1)
+#define UG_METRICS_DEC(field) UG_METRICS_ADD(field, -1)
+
+/* node is a slot + 1, 0 when the gadget is not mirrored */
+static inline void ug_metrics_state(int node, int old, int state)
+{
+	UG_METRICS_DEC(alive[old]);
+	UG_METRICS_INC(alive[state]);
+	if (node)
+		__atomic_store_n(&ug_metrics->nodes[node - 1].state, state,
+				 __ATOMIC_RELAXED);
+}
+
+static inline int ug_metrics_lag_bucket(uint64_t ns)
+{
+	uint64_t us = ns / 1000;
+	int b = 0;
+
+	while (us > 1 && b < UG_METRICS_LAG_BUCKETS - 1) {
+		us >>= 1;
+		b++;
+	}
+
+	return b;
+}
+
+static inline void ug_metrics_layout(int node, int state)
+{
+	if (node)
+		__atomic_store_n(&ug_metrics->nodes[node - 1].layout, state,
+				 __ATOMIC_RELAXED);
+}
+
+struct ui_gadget_s;
+struct service_s;
+
+int ug_metrics_init(void);
+void ug_metrics_node_add(struct ui_gadget_s *ug);
+void ug_metrics_node_parent(struct ui_gadget_s *ug);
+void ug_metrics_node_del(struct ui_gadget_s *ug);
+void ug_metrics_message(struct service_s *msg, int result);
+int ug_metrics_job(const char *name);
+void ug_metrics_job_run(int job, uint64_t lag_ns);
+void ug_metrics_job_done(int job);
+
+#endif				/* __UG_METRICS_H__ */
@@ -24,14 +24,23 @@
 
 #include "ui-gadget-module.h"
 
+struct ug_module_entry;
+
 struct ug_module {
 	void *handle;
 	char *module_name;
 	struct ug_module_ops ops;
+	struct ug_module_entry *entry;
+	struct ug_load_times times;
 };
 
+int ug_module_init(void);
 struct ug_module *ug_module_load(const char *name);
 int ug_module_unload(struct ug_module *module);
 int ug_exist(const char* name);
+int ug_module_preload(const char *names[], int count, int flags);
+void ug_module_purge(void);
+void *ug_module_prefetch(const char *name);
+void ug_module_prefetch_release(void *handle);
 
 #endif				/* __UG_MODULE_H__ */
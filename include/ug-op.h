@@ -0,0 +1,77 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_OP_H__
+#define __UG_OP_H__
+
+#include "ug.h"
+#include "ug-flight.h"
+#include "ug-trace.h"
+#include "ug-opstats.h"
+#include "ug-perf.h"
+#include "ug-prof.h"
+
+/* calls from the manager into module operations */
+enum ug_op {
+	UG_OP_CREATE = UG_MODULE_OP_CREATE,
+	UG_OP_START = UG_MODULE_OP_START,
+	UG_OP_PAUSE = UG_MODULE_OP_PAUSE,
+	UG_OP_RESUME = UG_MODULE_OP_RESUME,
+	UG_OP_EVENT = UG_MODULE_OP_EVENT,
+	UG_OP_MESSAGE = UG_MODULE_OP_MESSAGE,
+	UG_OP_KEY_EVENT = UG_MODULE_OP_KEY_EVENT,
+	UG_OP_DESTROYING = UG_MODULE_OP_DESTROYING,
+	UG_OP_DESTROY = UG_MODULE_OP_DESTROY,
+	UG_OP_MAX = UG_MODULE_OP_MAX
+};
+
+static inline const char *ug_op_name(enum ug_op op)
+{
+	static const char *names[UG_OP_MAX] = {
+		"create", "start", "pause", "resume", "event", "message",
+		"key_event", "destroying", "destroy"
+	};
+
+	return op < UG_OP_MAX ? names[op] : "unknown";
+}
+
+/* every module operation call is bracketed by these */
+static inline void ug_op_enter(ui_gadget_h ug, enum ug_op op)
+{
+	ug_flight_mark(ug, op);
+	UG_TRACE_BEGIN(UG_TRACE_CAT_OP, ug_op_name(op), ug);
+	ug_opstats_enter(ug, op);
+	UG_PROF_ENTER(ug, ug_op_name(op));
+	if (ug_perf_enabled)
+		ug_perf_enter(ug, op);
+}
+
+static inline void ug_op_leave(ui_gadget_h ug, enum ug_op op)
+{
+	if (ug_perf_enabled)
+		ug_perf_leave(ug, op);
+	UG_PROF_LEAVE();
+	ug_opstats_leave(ug, op);
+	ug_flight_mark(ug, op | UG_FLIGHT_LEAVE);
+	UG_TRACE_END(UG_TRACE_CAT_OP, ug_op_name(op), ug);
+}
+
+#endif				/* __UG_OP_H__ */
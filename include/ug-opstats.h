@@ -0,0 +1,53 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_OPSTATS_H__
+#define __UG_OPSTATS_H__
+
+#include "ui-gadget.h"
+
+struct ug_opstats_module;
+
+/*
+ * Wall-clock and thread CPU timing of module operations, kept per module
+ * name in the histograms of struct ug_op_timing, and the watchdog of
+ * ug_set_op_budget(). CPU time is only taken while a budget is set.
+ * Operations are only called from the main loop.
+ */
+
+/* same as the public remark of ug_set_op_budget() */
+#define UG_OP_WATCHDOG_SIGNAL (SIGRTMIN + 5)
+
+/* deeper nesting is not timed */
+#define UG_OP_DEPTH_MAX 16
+
+void ug_opstats_enter(ui_gadget_h ug, int op);
+void ug_opstats_leave(ui_gadget_h ug, int op);
+int ug_opstats_init(void);
+int ug_opstats_budget_set(unsigned long long budget_ns, int with_backtrace);
+int ug_opstats_module_get(const char *name, struct ug_module_op_stats *stats);
+int ug_opstats_foreach(int (*func) (const char *name,
+				    const struct ug_module_op_stats *stats,
+				    void *data), void *data);
+int ug_opstats_bucket(unsigned long long ns);
+unsigned long long ug_opstats_bucket_ns(int bucket);
+
+#endif				/* __UG_OPSTATS_H__ */
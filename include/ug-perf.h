@@ -0,0 +1,52 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_PERF_H__
+#define __UG_PERF_H__
+
+#include "ui-gadget.h"
+
+/*
+ * Hardware counter mode, off unless UG_PERF is set at ug_init(): every
+ * module operation is bracketed with perf_event_open counters of the
+ * calling thread, and the deltas are summed per gadget name and op.
+ * The sums are appended to UG_PERF (or "/tmp/ug-perf-<pid>.txt" when it
+ * is "1") on SIGUSR2 and when the gadget tree is gone. The file is
+ * created afresh at ug_init() by ug_file_create().
+ */
+
+enum ug_perf_counter {
+	UG_PERF_INSTRUCTIONS = 0x00,
+	UG_PERF_CYCLES,
+	UG_PERF_CACHE_MISSES,
+	UG_PERF_MINOR_FAULTS,
+	UG_PERF_MAJOR_FAULTS,
+	UG_PERF_MAX
+};
+
+extern int ug_perf_enabled;
+
+int ug_perf_init(void);
+void ug_perf_enter(ui_gadget_h ug, int op);
+void ug_perf_leave(ui_gadget_h ug, int op);
+void ug_perf_dump(void);
+
+#endif				/* __UG_PERF_H__ */
@@ -0,0 +1,48 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_PROBE_H__
+#define __UG_PROBE_H__
+
+/*
+ * USDT probes of the "ui_gadget" provider, for perf and bpftrace:
+ *
+ *   bpftrace -e 'usdt:/usr/lib/libui-gadget-1.so.0:ui_gadget:create
+ *                { printf("%s\n", str(arg1)); }'
+ *
+ * Every probe carries the gadget, its name and state; UG_PROBE1() adds one
+ * more argument. A probe is a nop until a tracer attaches to it. Without
+ * sys/sdt.h at build time (see the PROBES option) there are no probes.
+ */
+
+#ifdef UG_PROBES
+#include <sys/sdt.h>
+
+#define UG_PROBE(probe, ug) \
+	DTRACE_PROBE3(ui_gadget, probe, (ug), (ug)->name, (ug)->state)
+#define UG_PROBE1(probe, ug, arg) \
+	DTRACE_PROBE4(ui_gadget, probe, (ug), (ug)->name, (ug)->state, (arg))
+#else
+#define UG_PROBE(probe, ug) do { } while (0)
+#define UG_PROBE1(probe, ug, arg) do { } while (0)
+#endif
+
+#endif				/* __UG_PROBE_H__ */
@@ -0,0 +1,70 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_PROF_H__
+#define __UG_PROF_H__
+
+#include "ui-gadget.h"
+
+/*
+ * Sampling profiler, off unless UG_PROF is set at ug_init(): a timer on
+ * the CPU time of the main thread raises SIGPROF UG_PROF_HZ times a second
+ * (99 without it), and each sample is tagged with the gadget the main loop
+ * is working for. That is the innermost UG_PROF_ENTER() (module operations
+ * and engine calls in the manager, EFL callbacks in the engine) or, between
+ * them, the gadget whose show or hide effect is running.
+ *
+ * Samples are folded into "gadget;what;frame;...;frame count" lines, the
+ * input of flamegraph.pl, and written to UG_PROF (or
+ * "/tmp/ug-prof-<pid>.folded" when it is "1") on SIGUSR2 and when the
+ * gadget tree is gone. The file is created afresh at ug_init() by
+ * ug_file_create().
+ */
+
+/* UG_INTERNAL_API, for the engine, like the functions below */
+extern int ug_prof_enabled;
+
+int ug_prof_init(void);
+void ug_prof_enter(ui_gadget_h ug, const char *what);
+void ug_prof_leave(void);
+void ug_prof_effect(ui_gadget_h ug, int running);
+void ug_prof_dump(void);
+
+/* what must be a string literal or otherwise outlive the process */
+#define UG_PROF_ENTER(ug, what) \
+	do { \
+		if (ug_prof_enabled) \
+			ug_prof_enter((ug), (what)); \
+	} while (0)
+
+#define UG_PROF_LEAVE() \
+	do { \
+		if (ug_prof_enabled) \
+			ug_prof_leave(); \
+	} while (0)
+
+#define UG_PROF_EFFECT(ug, running) \
+	do { \
+		if (ug_prof_enabled) \
+			ug_prof_effect((ug), (running)); \
+	} while (0)
+
+#endif				/* __UG_PROF_H__ */
@@ -0,0 +1,63 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_SCHED_H__
+#define __UG_SCHED_H__
+
+#include <Ecore.h>
+
+/*
+ * Deferred work of the manager, the engine and the module registry, by
+ * priority:
+ *
+ *   UG_SCHED_URGENT      pause, resume and rotation, all of it runs at
+ *                        the next main loop iteration; pause and resume
+ *                        share the priority to keep their call order
+ *   UG_SCHED_NORMAL      other events, run within a per-frame
+ *                        budget (UG_SCHED_BUDGET_MS, 4 by default); what
+ *                        does not fit continues on the next animator tick
+ *   UG_SCHED_BACKGROUND  destroy, module unload and preload, run when the
+ *                        loop is idle, or one per frame after waiting
+ *                        UG_SCHED_BACKGROUND_AGE so animations cannot
+ *                        starve them
+ *
+ * Jobs run in FIFO order within a priority. A job returning
+ * ECORE_CALLBACK_RENEW is queued again at the tail of its priority.
+ */
+
+enum ug_sched_prio {
+	UG_SCHED_URGENT,
+	UG_SCHED_NORMAL,
+	UG_SCHED_BACKGROUND,
+	UG_SCHED_PRIO_MAX,
+};
+
+#define UG_SCHED_BUDGET_MS 4
+#define UG_SCHED_BACKGROUND_AGE 0.5
+
+struct ug_sched_job;
+
+int ug_sched_init(void);
+/* UG_INTERNAL_API, for the engine */
+struct ug_sched_job *ug_sched_add(enum ug_sched_prio prio, Ecore_Task_Cb func,
+				  const void *data, const char *name);
+
+#endif				/* __UG_SCHED_H__ */
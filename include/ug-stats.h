@@ -0,0 +1,39 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_STATS_H__
+#define __UG_STATS_H__
+
+#include "ui-gadget.h"
+
+/*
+ * Lifecycle timestamps live in struct ui_gadget_s and are marked by the
+ * manager and the engine. When a gadget is destroyed they are folded into
+ * the latency statistics of its module name.
+ */
+
+/* UG_INTERNAL_API, for the engine, which marks the show and hide edges */
+void ug_stats_mark(ui_gadget_h ug, enum ug_stats_edge edge);
+void ug_stats_fold(ui_gadget_h ug);
+int ug_stats_module_get(const char *name, struct ug_module_stats *stats);
+unsigned long long ug_stats_now(void);
+
+#endif				/* __UG_STATS_H__ */
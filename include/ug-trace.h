@@ -0,0 +1,64 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __UG_TRACE_H__
+#define __UG_TRACE_H__
+
+#include <Ecore.h>
+#include "ui-gadget.h"
+
+/*
+ * Chrome trace-event recorder, off unless UG_TRACE names an output file
+ * at ug_init(), which creates it afresh with ug_file_create(). Events are
+ * kept in memory and appended to the file, in the JSON array format, by
+ * ug_trace_flush(): when the gadget tree is gone, when the buffer is
+ * full, and on SIGUSR2.
+ *
+ * Categories: "module" (loading), "op" (module operations), "engine"
+ * (engine calls and effects, effects are async spans keyed by the
+ * gadget) and "idler" (deferred jobs of ug-sched.h).
+ */
+
+#define UG_TRACE_CAT_MODULE "module"
+#define UG_TRACE_CAT_OP "op"
+#define UG_TRACE_CAT_ENGINE "engine"
+#define UG_TRACE_CAT_IDLER "idler"
+
+/* UG_INTERNAL_API, for the engine, like the functions below */
+extern int ug_trace_enabled;
+
+int ug_trace_init(void);
+void ug_trace_flush(void);
+void ug_trace_event(char ph, const char *cat, const char *name,
+		    ui_gadget_h ug);
+
+#define UG_TRACE(ph, cat, name, ug) \
+	do { \
+		if (ug_trace_enabled) \
+			ug_trace_event((ph), (cat), (name), (ug)); \
+	} while (0)
+
+#define UG_TRACE_BEGIN(cat, name, ug) UG_TRACE('B', cat, name, ug)
+#define UG_TRACE_END(cat, name, ug) UG_TRACE('E', cat, name, ug)
+#define UG_TRACE_ASYNC_BEGIN(cat, name, ug) UG_TRACE('b', cat, name, ug)
+#define UG_TRACE_ASYNC_END(cat, name, ug) UG_TRACE('e', cat, name, ug)
+
+#endif				/* __UG_TRACE_H__ */
@@ -22,11 +22,24 @@
 #ifndef __UG_H__
 #define __UG_H__
 
+#include <stdio.h>
 #include <bundle.h>
 #include "ug-module.h"
+#include "ug-flight.h"
+#include "ug-metrics.h"
 #include "ui-gadget.h"
 
-struct ug_child;
+/* the public API, declared in ui-gadget.h and ui-gadget-module.h */
+#ifndef UG_API
+#define UG_API __attribute__ ((visibility("default")))
+#endif
+
+/*
+ * Internals the engine, a separate shared object, calls or reads. They
+ * are exported for it alone, are declared in no installed header and
+ * are not part of the API: keep this list short.
+ */
+#define UG_INTERNAL_API __attribute__ ((visibility("default")))
 
 enum ug_state {
 	UG_STATE_READY = 0x00,
@@ -57,8 +70,16 @@ struct ui_gadget_s {
 	enum ug_mode mode;
 	enum ug_option opt;
 
+	/* gadget tree, children are kept newest first */
 	ui_gadget_h parent;
-	void *children;
+	ui_gadget_h first_child;
+	ui_gadget_h last_child;
+	ui_gadget_h next_sibling;
+	ui_gadget_h prev_sibling;
+
+	/* fullview stack, linked while the gadget is on it */
+	ui_gadget_h fv_below;
+	ui_gadget_h fv_above;
 
 	struct ug_module *module;
 	struct ug_cbs cbs;
@@ -66,11 +87,69 @@ struct ui_gadget_s {
 	service_h service;
 
 	int destroy_me:1;
+	/* the engine's destroy_end waits for a child's hide effect */
+	int destroy_end_wait:1;
 	enum ug_layout_state layout_state;
 	void *effect_layout;
+
+	/* lifecycle timestamps, see ug-stats.h */
+	struct ug_stats stats;
+
+	/* name index of the flight recorder */
+	uint32_t flight_name;
+
+	/* slot + 1 in the shared tree of ug-metrics.h, 0: none */
+	int metrics_node;
+
+	/* operation timings of the module, see ug-opstats.h */
+	struct ug_opstats_module *opstats;
+
+	/* UG_EVENT_MASK() bits of the events the gadget, and any gadget in
+	 * its subtree, takes; broadcasts skip subtrees without takers */
+	unsigned int event_mask;
+	unsigned int subtree_event_mask;
 };
 
+static inline void ug_flight_mark(ui_gadget_h ug, unsigned int op)
+{
+	ug_flight_record(ug, ug->flight_name, op, ug->state, ug->state,
+			 ug->layout_state, ug->layout_state);
+}
+
+/* state changes go through these, so the flight recorder and the live
+ * metrics see them */
+static inline void ug_state_set(ui_gadget_h ug, enum ug_state state)
+{
+	ug_flight_record(ug, ug->flight_name, UG_FLIGHT_OP_STATE,
+			 ug->state, state, ug->layout_state, ug->layout_state);
+	ug_metrics_state(ug->metrics_node, ug->state, state);
+	ug->state = state;
+}
+
+static inline void ug_layout_state_set(ui_gadget_h ug,
+				       enum ug_layout_state state)
+{
+	ug_flight_record(ug, ug->flight_name, UG_FLIGHT_OP_LAYOUT,
+			 ug->state, ug->state, ug->layout_state, state);
+	ug_metrics_layout(ug->metrics_node, state);
+	ug->layout_state = state;
+}
+
 ui_gadget_h ug_root_create(void);
 int ug_free(ui_gadget_h ug);
+FILE *ug_file_create(const char *path);
+
+/*
+ * Non-recursive walk of the subtree of ug, ug included, children newest
+ * first. pre is called on the way down, returning 0 skips the gadget's
+ * subtree and its post visit. post is called once the subtree is done,
+ * and may unlink and free the gadget it is given. Either may be NULL.
+ * UG_INTERNAL_API: exported for the engine only.
+ */
+typedef int (*ug_tree_pre_cb) (ui_gadget_h ug, void *data);
+typedef void (*ug_tree_post_cb) (ui_gadget_h ug, void *data);
+
+void ug_tree_walk(ui_gadget_h ug, ug_tree_pre_cb pre, ug_tree_post_cb post,
+		  void *data);
 
 #endif				/* __UG_H__ */
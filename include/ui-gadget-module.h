@@ -44,6 +44,25 @@
 extern "C" {
 #endif
 
+/**
+ * Bit of an enum ug_event in ug_module_ops.event_mask
+ */
+#define UG_EVENT_MASK(event) (1U << (event))
+
+/**
+ * All rotate events
+ */
+#define UG_EVENT_MASK_ROTATE \
+	(UG_EVENT_MASK(UG_EVENT_ROTATE_PORTRAIT) | \
+	 UG_EVENT_MASK(UG_EVENT_ROTATE_PORTRAIT_UPSIDEDOWN) | \
+	 UG_EVENT_MASK(UG_EVENT_ROTATE_LANDSCAPE) | \
+	 UG_EVENT_MASK(UG_EVENT_ROTATE_LANDSCAPE_UPSIDEDOWN))
+
+/**
+ * All events
+ */
+#define UG_EVENT_MASK_ALL (~0U)
+
 /**
  * UI gadget module operation type
  * @see @ref lifecycle_sec
@@ -70,8 +89,10 @@ struct ug_module_ops {
 					service_h service, void *priv);
 	/** destroying operation */
 	void (*destroying) (ui_gadget_h ug, service_h service, void *priv);
+	/** events the event operation is called for, UG_EVENT_MASK() bits (0: all events) */
+	unsigned int event_mask;
 	/** reserved operations */
-	void *reserved[3];
+	void *reserved[2];
 
 	/** private data */
 	void *priv;
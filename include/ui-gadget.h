@@ -133,6 +133,151 @@ enum ug_option {
 	UG_OPT_MAX
 };
 
+/**
+ * UI gadget preload flags
+ * @see ug_preload()
+ */
+enum ug_preload_flag {
+	UG_PRELOAD_DEFAULT = 0x00,
+			/**< Preload option: Resolve and load the module only */
+	UG_PRELOAD_INIT = 0x01,
+			/**< Preload option: Also initialize the module (UG_MODULE_INIT) */
+};
+
+/**
+ * UI gadget log level
+ * @see ug_set_log_level()
+ */
+enum ug_log_level {
+	UG_LOG_LEVEL_NONE = 0x00,	/**< No log */
+	UG_LOG_LEVEL_ERROR,		/**< Error logs only */
+	UG_LOG_LEVEL_WARN,		/**< Warning and error logs */
+	UG_LOG_LEVEL_INFO,		/**< Info, warning and error logs */
+	UG_LOG_LEVEL_DEBUG,		/**< All logs */
+	UG_LOG_LEVEL_MAX
+};
+
+/**
+ * UI gadget module load phase
+ * @see ug_get_load_times()
+ */
+enum ug_load_phase {
+	UG_LOAD_PHASE_PACKAGE = 0x00,
+			/**< Load phase: Package lookup, only if the module loader was not initialized yet */
+	UG_LOAD_PHASE_PATH,	/**< Load phase: Module path lookup */
+	UG_LOAD_PHASE_DLOPEN,	/**< Load phase: Dynamic loading(dlopen) */
+	UG_LOAD_PHASE_SYMBOL,	/**< Load phase: Entry point lookup(dlsym) */
+	UG_LOAD_PHASE_INIT,	/**< Load phase: Module initialization(UG_MODULE_INIT) */
+	UG_LOAD_PHASE_MAX
+};
+
+/**
+ * UI gadget module load times
+ * All times are CLOCK_MONOTONIC timestamps in nanoseconds. Phases which were skipped are 0.
+ * @see ug_get_load_times()
+ */
+struct ug_load_times {
+	unsigned long long begin;	/**< Load begin */
+	unsigned long long end;		/**< Load end */
+	struct {
+		unsigned long long begin;
+		unsigned long long end;
+	} phases[UG_LOAD_PHASE_MAX];	/**< Begin and end of each phase (see enum ug_load_phase) */
+	int cached;			/**< Non-zero if the module was already loaded */
+	int warm;			/**< Non-zero if the module was initialized by ug_preload() */
+};
+
+/**
+ * UI gadget lifecycle edge
+ * @see ug_get_stats(), ug_get_module_stats()
+ */
+enum ug_stats_edge {
+	UG_STATS_EDGE_LOAD_REQUESTED = 0x00,
+			/**< Lifecycle edge: ug_create() or ug_create_async() is called */
+	UG_STATS_EDGE_MODULE_LOADED,	/**< Lifecycle edge: Module is loaded */
+	UG_STATS_EDGE_CREATED,		/**< Lifecycle edge: Create operation returned */
+	UG_STATS_EDGE_LAYOUT_DONE,	/**< Lifecycle edge: Layout callback returned */
+	UG_STATS_EDGE_SHOW_BEGIN,	/**< Lifecycle edge: Show effect started */
+	UG_STATS_EDGE_SHOW_END,		/**< Lifecycle edge: Show effect finished */
+	UG_STATS_EDGE_STARTED,		/**< Lifecycle edge: Start operation is called */
+	UG_STATS_EDGE_DESTROY_REQUESTED,
+			/**< Lifecycle edge: ug_destroy() or ug_destroy_all() is called, or the parent is destroyed */
+	UG_STATS_EDGE_HIDE_END,		/**< Lifecycle edge: Hide effect finished */
+	UG_STATS_EDGE_DESTROYED,	/**< Lifecycle edge: UI gadget is destroyed */
+	UG_STATS_EDGE_MAX
+};
+
+/**
+ * UI gadget lifecycle timestamps
+ * All times are CLOCK_MONOTONIC timestamps in nanoseconds. Edges which are not reached yet are 0.
+ * @see ug_get_stats()
+ */
+struct ug_stats {
+	unsigned long long edges[UG_STATS_EDGE_MAX];	/**< Timestamp of each edge (see enum ug_stats_edge) */
+};
+
+/**
+ * UI gadget lifecycle latencies of a module
+ * Edges up to UG_STATS_EDGE_STARTED are measured from UG_STATS_EDGE_LOAD_REQUESTED, and the rest from UG_STATS_EDGE_DESTROY_REQUESTED, in nanoseconds.
+ * @see ug_get_module_stats()
+ */
+struct ug_module_stats {
+	unsigned int count;		/**< Number of destroyed UI gadgets counted in */
+	struct {
+		unsigned int count;	/**< Number of UI gadgets which reached the edge */
+		unsigned long long min;	/**< Minimum latency */
+		unsigned long long avg;	/**< Average latency */
+		unsigned long long p99;	/**< 99th percentile latency of the last UG_STATS_WINDOW UI gadgets */
+	} edges[UG_STATS_EDGE_MAX];	/**< Latency of each edge (see enum ug_stats_edge) */
+};
+
+/** Number of recent UI gadgets the percentiles of struct ug_module_stats are taken from */
+#define UG_STATS_WINDOW 128
+
+/**
+ * UI gadget module operation
+ * @see struct ug_module_ops, ug_get_module_op_stats()
+ */
+enum ug_module_op {
+	UG_MODULE_OP_CREATE = 0x00,	/**< create operation */
+	UG_MODULE_OP_START,		/**< start operation */
+	UG_MODULE_OP_PAUSE,		/**< pause operation */
+	UG_MODULE_OP_RESUME,		/**< resume operation */
+	UG_MODULE_OP_EVENT,		/**< event operation */
+	UG_MODULE_OP_MESSAGE,		/**< message operation */
+	UG_MODULE_OP_KEY_EVENT,		/**< key_event operation */
+	UG_MODULE_OP_DESTROYING,	/**< destroying operation */
+	UG_MODULE_OP_DESTROY,		/**< destroy operation */
+	UG_MODULE_OP_MAX
+};
+
+/** Number of histogram buckets of struct ug_op_timing (see ug_op_bucket_ns()) */
+#define UG_OP_HIST_BUCKETS 96
+
+/**
+ * Timing of a module operation
+ * Wall-clock and thread CPU times are in nanoseconds. Thread CPU time is only measured while a budget is set (see ug_set_op_budget()). Nested operations (e.g. a UI gadget created from the create operation of another) are counted in the outer one as well.
+ * @see ug_get_module_op_stats()
+ */
+struct ug_op_timing {
+	unsigned long long count;	/**< Number of calls */
+	unsigned long long overruns;	/**< Number of calls over the budget (see ug_set_op_budget()) */
+	unsigned long long wall_sum;	/**< Total wall-clock time */
+	unsigned long long wall_max;	/**< Longest wall-clock time */
+	unsigned long long cpu_sum;	/**< Total thread CPU time */
+	unsigned long long cpu_max;	/**< Longest thread CPU time */
+	unsigned int wall_hist[UG_OP_HIST_BUCKETS];	/**< Calls by wall-clock time */
+	unsigned int cpu_hist[UG_OP_HIST_BUCKETS];	/**< Calls by thread CPU time */
+};
+
+/**
+ * Operation timings of a module
+ * @see ug_get_module_op_stats(), ug_foreach_module_op_stats()
+ */
+struct ug_module_op_stats {
+	struct ug_op_timing ops[UG_MODULE_OP_MAX];	/**< Timing of each operation (see enum ug_module_op) */
+};
+
 #define GET_OPT_INDICATOR_VAL(opt) opt % UG_OPT_OVERLAP_ENABLE
 #define GET_OPT_OVERLAP_VAL(opt) opt & UG_OPT_OVERLAP_ENABLE
 
@@ -140,7 +285,7 @@ enum ug_option {
 
 /**
  * UI gadget callback type
- * @see ug_create()
+ * @see ug_create(), ug_create_async()
  */
 struct ug_cbs {
 	/** layout callback */
@@ -154,7 +299,9 @@ struct ug_cbs {
 	void (*end_cb) (ui_gadget_h ug, void *priv);
 	/** private data */
 	void *priv;
-	void *reserved[3];
+	/** create callback, only for ug_create_async() */
+	void (*create_cb) (ui_gadget_h ug, int result, void *priv);
+	void *reserved[2];
 };
 
 /**
@@ -275,6 +422,57 @@ ui_gadget_h ug_create(ui_gadget_h parent, const char *name,
 					enum ug_mode mode, service_h service,
 					struct ug_cbs *cbs);
 
+/**
+ * \par Description:
+ * This function creates a UI gadget asynchronously
+ *
+ * \par Purpose:
+ * This function is used for creating a UI gadget instance without blocking the main loop while its module is loaded.
+ *
+ * \par Typical use case:
+ * Anyone who want to create a heavy UI gadget without dropping frames
+ *
+ * \par Method of function operation:
+ * The module of the UI gadget is resolved, read ahead and dynamically loaded(dlopen) in a worker thread. Then, the module is initialized and the UI gadget is created in the main loop as ug_create() does. When it is done, the create callback is invoked with the new UI gadget and 0, or with NULL and -1 on failure.
+ *
+ * \par Context of function:
+ * This function supposed to be called after successful initialization with ug_init()
+ *
+ * @param[in] parent parent's UI gadget. If the UI gadget uses the function, the parent has to be the UI gadget. Otherwise, if an application uses the function, the parent has to be NULL
+ * @param[in] name name of UI gadget
+ * @param[in] mode mode of UI gadget (UG_MODE_FULLVIEW | UG_MODE_FRAMEVIEW)
+ * @param[in] service argument for the UI gadget  (see \ref service_PG "Tizen managed api reference guide")
+ * @param[in] cbs callback functions including create callback, and private data.
+ * @return 0 on success, -1 on error
+ *
+ * \pre ug_init()
+ * \post None
+ * \see ug_create(), struct ug_cbs
+ * \remarks The creation fails if the parent is destroyed before it is done. Constructors of the module run in the worker thread, so they must not use the main loop.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * static void _create_cb(ui_gadget_h ug, int result, void *priv)
+ * {
+ * if (result)
+ * // handle failure
+ * ...
+ * }
+ * ...
+ * cbs.layout_cb = _layout_cb;
+ * cbs.create_cb = _create_cb;
+ * cbs.priv = user_data;
+ *
+ * ug_create_async(NULL, "helloUG-efl", UG_MODE_FULLVIEW, service, &cbs);
+ * ...
+ * \endcode
+ */
+int ug_create_async(ui_gadget_h parent, const char *name,
+					enum ug_mode mode, service_h service,
+					struct ug_cbs *cbs);
+
 /**
  * \par Description:
  * This function pauses all UI gadgets
@@ -602,6 +800,8 @@ enum ug_mode ug_get_mode(ui_gadget_h ug);
  *
  * \par Method of function operation:
  * Event operations of all UI gadgets in the UI gadget tree are invoked by post-order traversal.
+ * A UI gadget whose module sets ug_module_ops.event_mask only gets the events in the mask, and subtrees without such UI gadgets are not traversed.
+ * Events are delivered asynchronously. Until then, a newer rotate event replaces a pending one and a repeated event is delivered once. Pending events are delivered together in one traversal.
  *
  * \par Context of function:
  * This function supposed to be called after successful initialization with ug_init()
@@ -779,6 +979,349 @@ int ug_disable_effect(ui_gadget_h ug);
  */
 int ug_is_installed(const char *name);
 
+/**
+ * \par Description:
+ * This function preloads UI gadget modules
+ *
+ * \par Purpose:
+ * This function is used for loading UI gadget modules ahead of ug_create(), so that creating them later does not pay for the module loading.
+ *
+ * \par Typical use case:
+ * Anyone who knows which UI gadgets are likely to be created next, e.g. the targets of the current view
+ *
+ * \par Method of function operation:
+ * Given names are queued and loaded one by one while the main loop is idle. Each module is resolved and dynamically loaded(dlopen). With UG_PRELOAD_INIT, the module is also initialized and the next ug_create() with the name uses the initialized module. On UG_EVENT_LOW_MEMORY, pending preloads are cancelled and every module without a live UI gadget is unloaded: modules which are preloaded but not used yet, and modules kept loaded for a while after their last UI gadget was destroyed.
+ *
+ * \par Context of function:
+ * This function supposed to be called in the main loop
+ *
+ * @param[in] names names of UI gadgets
+ * @param[in] count number of names
+ * @param[in] flags preload flags (see enum ug_preload_flag)
+ * @return 0 on success, -1 on error
+ *
+ * \pre None
+ * \post None
+ * \see ug_create(), enum ug_preload_flag
+ * \remarks Errors of loading each module are not reported. ug_create() reports them as usual.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * const char *names[] = { "helloUG-efl", "worldUG-efl" };
+ *
+ * ug_preload(names, 2, UG_PRELOAD_INIT);
+ * ...
+ * \endcode
+ */
+int ug_preload(const char *names[], int count, int flags);
+
+/**
+ * \par Description:
+ * This function sets the log level of the UI gadget library
+ *
+ * \par Purpose:
+ * This function is used for reducing the logs of the UI gadget library, and their cost.
+ *
+ * \par Typical use case:
+ * Anyone who want to turn the library logs down in production, or up for debugging
+ *
+ * \par Method of function operation:
+ * Logs above the given level are skipped before their arguments are evaluated. The initial level is taken from the UG_LOG_LEVEL environment variable (0-4, or none, error, warn, info, debug) at ug_init(), and is UG_LOG_LEVEL_DEBUG without it.
+ *
+ * \par Context of function:
+ * N/A
+ *
+ * @param[in] level log level (see enum ug_log_level)
+ * @return 0 on success, -1 on error
+ *
+ * \pre None
+ * \post None
+ * \see enum ug_log_level
+ * \remarks Debug and info logs are not available at all if the library is built with DEBUG_LOG off.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * ug_set_log_level(UG_LOG_LEVEL_WARN);
+ * ...
+ * \endcode
+ */
+int ug_set_log_level(enum ug_log_level level);
+
+/**
+ * \par Description:
+ * This function gets the times spent loading the module of the given UI gadget
+ *
+ * \par Purpose:
+ * This function is used for finding out why a UI gadget is slow to create.
+ *
+ * \par Typical use case:
+ * Anyone who want to know whether the time went to the path lookup, dynamic loading or initialization of the module
+ *
+ * \par Method of function operation:
+ * The module loader takes a timestamp at the begin and end of each phase while ug_create() loads the module, and keeps them with the UI gadget. With the UG_MODULE_TIMING environment variable set at ug_init(), each load is also logged as a single line.
+ *
+ * \par Context of function:
+ * This function supposed to be called after successful initialization with ug_init()
+ *
+ * @param[in] ug The UI gadget
+ * @param[out] times load times (see struct ug_load_times)
+ * @return 0 on success, -1 on error
+ *
+ * \pre ug_init()
+ * \post None
+ * \see struct ug_load_times, enum ug_load_phase
+ * \remarks If the module was already loaded, only the initialization phase is timed. If it was preloaded with UG_PRELOAD_INIT, no phase is.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * struct ug_load_times t;
+ *
+ * if (!ug_get_load_times(ug, &t))
+ *	printf("dlopen: %llu ns\n", t.phases[UG_LOAD_PHASE_DLOPEN].end -
+ *	       t.phases[UG_LOAD_PHASE_DLOPEN].begin);
+ * ...
+ * \endcode
+ */
+int ug_get_load_times(ui_gadget_h ug, struct ug_load_times *times);
+
+/**
+ * \par Description:
+ * This function gets the lifecycle timestamps of the given UI gadget
+ *
+ * \par Purpose:
+ * This function is used for measuring how long a UI gadget takes to show up, and to go away.
+ *
+ * \par Typical use case:
+ * Anyone who want to check a UI gadget against its tap-to-first-frame budget
+ *
+ * \par Method of function operation:
+ * The UI gadget manager and engine take a timestamp at each lifecycle edge of the UI gadget (see enum ug_stats_edge).
+ *
+ * \par Context of function:
+ * This function supposed to be called after successful initialization with ug_init()
+ *
+ * @param[in] ug The UI gadget
+ * @param[out] stats lifecycle timestamps (see struct ug_stats)
+ * @return 0 on success, -1 on error
+ *
+ * \pre ug_init()
+ * \post None
+ * \see ug_get_module_stats(), enum ug_stats_edge
+ * \remarks Engine edges are not reached by frameview UI gadgets.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * struct ug_stats s;
+ *
+ * if (!ug_get_stats(ug, &s) && s.edges[UG_STATS_EDGE_SHOW_END])
+ *	printf("first frame: %llu ns\n", s.edges[UG_STATS_EDGE_SHOW_END] -
+ *	       s.edges[UG_STATS_EDGE_LOAD_REQUESTED]);
+ * ...
+ * \endcode
+ */
+int ug_get_stats(ui_gadget_h ug, struct ug_stats *stats);
+
+/**
+ * \par Description:
+ * This function gets the lifecycle latencies of all destroyed UI gadgets with the given name
+ *
+ * \par Purpose:
+ * This function is used for checking a UI gadget module against its latency budgets.
+ *
+ * \par Typical use case:
+ * Anyone who want to enforce tap-to-first-frame budgets per UI gadget
+ *
+ * \par Method of function operation:
+ * When a UI gadget is destroyed, its lifecycle timestamps are added to the statistics of its name: minimum and average over all UI gadgets, and 99th percentile over the last UG_STATS_WINDOW ones.
+ *
+ * \par Context of function:
+ * This function supposed to be called after successful initialization with ug_init()
+ *
+ * @param[in] name UI gadget name
+ * @param[out] stats lifecycle latencies (see struct ug_module_stats)
+ * @return 0 on success, -1 on error
+ *
+ * \pre ug_init()
+ * \post None
+ * \see ug_get_stats(), enum ug_stats_edge
+ * \remarks Returns -1 if no UI gadget with the name was destroyed yet.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * struct ug_module_stats s;
+ *
+ * if (!ug_get_module_stats("helloUG-efl", &s) &&
+ *     s.edges[UG_STATS_EDGE_SHOW_END].p99 > 300000000ULL)
+ *	printf("helloUG-efl is over budget\n");
+ * ...
+ * \endcode
+ */
+int ug_get_module_stats(const char *name, struct ug_module_stats *stats);
+
+/**
+ * \par Description:
+ * This function gets the operation timings of the UI gadget module with the given name
+ *
+ * \par Purpose:
+ * This function is used for finding the UI gadget operations which stall the main loop.
+ *
+ * \par Typical use case:
+ * Anyone who want to know how long the operations of a UI gadget module take
+ *
+ * \par Method of function operation:
+ * Every call of the UI gadget manager into a module operation is timed in wall-clock time, and in thread CPU time while a budget is set (see ug_set_op_budget()), and counted in log-linear histograms of the module name.
+ *
+ * \par Context of function:
+ * This function supposed to be called after successful initialization with ug_init()
+ *
+ * @param[in] name UI gadget name
+ * @param[out] stats operation timings (see struct ug_module_op_stats)
+ * @return 0 on success, -1 on error
+ *
+ * \pre ug_init()
+ * \post None
+ * \see ug_foreach_module_op_stats(), ug_op_bucket_ns(), ug_set_op_budget()
+ * \remarks Returns -1 if no operation of the module was called yet.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * struct ug_module_op_stats s;
+ *
+ * if (!ug_get_module_op_stats("helloUG-efl", &s))
+ *	printf("create: %llu ns max\n", s.ops[UG_MODULE_OP_CREATE].wall_max);
+ * ...
+ * \endcode
+ */
+int ug_get_module_op_stats(const char *name, struct ug_module_op_stats *stats);
+
+/**
+ * \par Description:
+ * This function calls the given function with the operation timings of every UI gadget module
+ *
+ * \par Purpose:
+ * This function is used for ranking UI gadget modules by the time their operations take.
+ *
+ * \par Typical use case:
+ * Anyone who want to know which UI gadgets cause jank
+ *
+ * \par Method of function operation:
+ * Calls the given function for each module whose operations were called, until it returns non-zero.
+ *
+ * \par Context of function:
+ * This function supposed to be called after successful initialization with ug_init()
+ *
+ * @param[in] func function called with the module name and its operation timings
+ * @param[in] data data passed to the function
+ * @return 0 on success, -1 on error
+ *
+ * \pre ug_init()
+ * \post None
+ * \see ug_get_module_op_stats()
+ * \remarks UI gadgets must not be created or destroyed from the function.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * static int add_up(const char *name, const struct ug_module_op_stats *s, void *data)
+ * {
+ *	int i;
+ *
+ *	for (i = 0; i < UG_MODULE_OP_MAX; i++)
+ *		printf("%s %llu\n", name, s->ops[i].wall_sum);
+ *	return 0;
+ * }
+ * ...
+ * ug_foreach_module_op_stats(add_up, NULL);
+ * ...
+ * \endcode
+ */
+int ug_foreach_module_op_stats(int (*func) (const char *name,
+					    const struct ug_module_op_stats *stats,
+					    void *data), void *data);
+
+/**
+ * \par Description:
+ * This function gets the lower bound of a histogram bucket of struct ug_op_timing
+ *
+ * \par Purpose:
+ * This function is used for turning the operation histograms into times.
+ *
+ * \par Typical use case:
+ * Anyone who want percentiles of the operation timings
+ *
+ * \par Method of function operation:
+ * Buckets are 1 us wide up to 8 us, then each power of two is split into 4 buckets. The last bucket takes everything from about 29 seconds up.
+ *
+ * \par Context of function:
+ * None
+ *
+ * @param[in] bucket bucket index, less than UG_OP_HIST_BUCKETS
+ * @return lower bound in nanoseconds
+ *
+ * \pre None
+ * \post None
+ * \see struct ug_op_timing
+ * \remarks None
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * printf("bucket 20 starts at %llu ns\n", ug_op_bucket_ns(20));
+ * ...
+ * \endcode
+ */
+unsigned long long ug_op_bucket_ns(int bucket);
+
+/**
+ * \par Description:
+ * This function sets the time budget of module operations
+ *
+ * \par Purpose:
+ * This function is used for catching UI gadget operations which block the main loop for too long.
+ *
+ * \par Typical use case:
+ * Anyone who want a warning, and where it got stuck, when a UI gadget operation overruns a frame
+ *
+ * \par Method of function operation:
+ * An operation that returns after the budget is logged with the module name, the operation and its duration. With backtrace set, a timer interrupts the operation when the budget runs out, and the backtrace of the main thread is written to stderr. The UG_OP_BUDGET_MS and UG_OP_BACKTRACE environment variables set both at ug_init().
+ *
+ * \par Context of function:
+ * This function supposed to be called from the main thread, after successful initialization with ug_init()
+ *
+ * @param[in] budget_ns budget in nanoseconds, 0 turns the watchdog off
+ * @param[in] backtrace non-zero to capture a backtrace of overruns
+ * @return 0 on success, -1 on error
+ *
+ * \pre ug_init()
+ * \post None
+ * \see ug_get_module_op_stats()
+ * \remarks The backtrace timer uses the real-time signal SIGRTMIN + 5.
+ *
+ * \par Sample code:
+ * \code
+ * #include <ui-gadget.h>
+ * ...
+ * // warn when an operation takes more than a frame
+ * ug_set_op_budget(16000000ULL, 0);
+ * ...
+ * \endcode
+ */
+int ug_set_op_budget(unsigned long long budget_ns, int backtrace);
+
 #ifdef __cplusplus
 }
 #endif
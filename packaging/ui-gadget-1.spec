@@ -46,6 +46,8 @@ rm -rf %{buildroot}
 %post 
 /sbin/ldconfig
 ln -sf /usr/bin/ug-client /usr/bin/ug-launcher
+mkdir -p /opt/usr/ug
+/usr/bin/ug-index || true
 
 %postun -p /sbin/ldconfig
 
@@ -56,6 +58,9 @@ ln -sf /usr/bin/ug-client /usr/bin/ug-launcher
 %{_libdir}/lib%{name}-efl-engine.so
 /usr/share/edje/ug_effect.edj
 %{_bindir}/ug-client
+%{_bindir}/ug-index
+%{_bindir}/ug-flight
+%{_bindir}/ug-top
 /usr/share/edje/ug-client/*.edj
 
 %files devel
@@ -0,0 +1,339 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "ug.h"
+#include "ug-flight.h"
+#include "ug-dbg.h"
+
+#define UG_FLIGHT_FILE_FMT "/tmp/ug-flight-%d.bin"
+
+/* room for the dump and a chained crash reporter after a stack overflow */
+#define UG_FLIGHT_STACK (64 * 1024)
+
+UG_INTERNAL_API struct ug_flight ug_flight;
+
+/* open addressing over names[], at most half full */
+#define UG_FLIGHT_NAME_HASH (UG_FLIGHT_NAMES * 2)
+
+#if UG_FLIGHT_NAMES > 256
+#error "name_hash holds name indexes in a byte"
+#endif
+
+struct ug_flight_dump {
+	struct ug_flight_header hdr;
+	/* name 0 is "" */
+	char names[UG_FLIGHT_NAMES][UG_FLIGHT_NAME_LEN];
+	uint32_t n_names;
+	/* index into names, 0: free slot */
+	uint8_t name_hash[UG_FLIGHT_NAME_HASH];
+	/* built ahead of time, nothing is formatted in the handler */
+	char path[256];
+	/* path with ".<n>" appended, for when path is taken */
+	char path_seq[256 + 2];
+	size_t path_len;
+	struct sigaction old_actions[NSIG];
+};
+
+static struct ug_flight_dump dump;
+
+static const int ug_flight_signals[] = { SIGSEGV, SIGBUS, SIGABRT };
+
+static uint64_t ug_flight_mono(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void ug_flight_write(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t r;
+
+	while (len > 0) {
+		r = write(fd, p, len);
+		if (r <= 0)
+			return;
+		p += r;
+		len -= r;
+	}
+}
+
+/*
+ * Hand the signal to whoever was there before, as if we were not: a
+ * fault the kernel raised for an instruction is raised again when it
+ * is retried, with the real si_addr and si_code and the state at the
+ * fault. Anything else goes to the old handler with our info and
+ * context, or takes its default action.
+ */
+static void ug_flight_chain(int signo, siginfo_t *info, void *uc)
+{
+	struct sigaction *old = &dump.old_actions[signo];
+
+	sigaction(signo, old, NULL);
+
+	if (signo != SIGABRT && info && info->si_code > 0)
+		return;
+
+	if (old->sa_flags & SA_SIGINFO)
+		old->sa_sigaction(signo, info, uc);
+	else if (old->sa_handler == SIG_DFL)
+		raise(signo);
+	else if (old->sa_handler != SIG_IGN)
+		old->sa_handler(signo);
+}
+
+/*
+ * Never through a symlink or into a file someone else left: a taken
+ * path moves the dump on to path.1 .. path.9.
+ */
+static int ug_flight_open(void)
+{
+	const int flags = O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC;
+	int fd;
+	int i;
+
+	fd = open(dump.path, flags, 0600);
+	for (i = 1; fd < 0 && errno == EEXIST && i <= 9; i++) {
+		dump.path_seq[dump.path_len + 1] = '0' + i;
+		fd = open(dump.path_seq, flags, 0600);
+	}
+
+	return fd;
+}
+
+/* async-signal-safe: open, write, close, clock_gettime, sigaction, raise */
+static void ug_flight_signal_handler(int signo, siginfo_t *info, void *uc)
+{
+	int fd;
+
+	ug_flight.enabled = 0;
+
+	dump.hdr.head = __atomic_load_n(&ug_flight.head, __ATOMIC_ACQUIRE);
+	dump.hdr.n_names = dump.n_names;
+	dump.hdr.signo = signo;
+	dump.hdr.ticks_dump = ug_flight_ticks();
+	dump.hdr.mono_dump = ug_flight_mono();
+
+	fd = ug_flight_open();
+	if (fd >= 0) {
+		ug_flight_write(fd, &dump.hdr, sizeof(dump.hdr));
+		ug_flight_write(fd, ug_flight.ring, sizeof(ug_flight.ring));
+		ug_flight_write(fd, dump.names,
+				dump.n_names * UG_FLIGHT_NAME_LEN);
+		close(fd);
+	}
+
+	ug_flight_chain(signo, info, uc);
+}
+
+/* FNV-1a over the part of the name that is kept */
+static uint32_t ug_flight_name_hash(const char *name)
+{
+	uint32_t h = 2166136261U;
+	int i;
+
+	for (i = 0; name[i] && i < UG_FLIGHT_NAME_LEN - 1; i++)
+		h = (h ^ (unsigned char)name[i]) * 16777619U;
+
+	return h;
+}
+
+/* called on every ug_create(): one hash probe, a string scan per name */
+uint32_t ug_flight_name(const char *name)
+{
+	uint32_t slot;
+	uint32_t i;
+
+	if (!name || !ug_flight.enabled)
+		return 0;
+
+	slot = ug_flight_name_hash(name) & (UG_FLIGHT_NAME_HASH - 1);
+	while ((i = dump.name_hash[slot])) {
+		if (!strncmp(dump.names[i], name, UG_FLIGHT_NAME_LEN - 1))
+			return i;
+		slot = (slot + 1) & (UG_FLIGHT_NAME_HASH - 1);
+	}
+
+	/* a full table records the later names as none */
+	if (dump.n_names == UG_FLIGHT_NAMES)
+		return 0;
+
+	i = dump.n_names++;
+	strncpy(dump.names[i], name, UG_FLIGHT_NAME_LEN - 1);
+	dump.name_hash[slot] = i;
+
+	return i;
+}
+
+#if defined(__arm__) && defined(__ARM_ARCH) && __ARM_ARCH >= 7
+static sigjmp_buf ug_flight_probe_env;
+
+static void ug_flight_probe_handler(int signo)
+{
+	siglongjmp(ug_flight_probe_env, 1);
+}
+
+/*
+ * The generic timer is optional on ARMv7 (Cortex-A9 has none) and the
+ * kernel decides if user space may read it: try once, catching SIGILL.
+ */
+static int ug_flight_cntvct_probe(void)
+{
+	struct sigaction sa;
+	struct sigaction old;
+	volatile int ok = 0;
+	uint64_t v;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = ug_flight_probe_handler;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(SIGILL, &sa, &old))
+		return 0;
+
+	if (!sigsetjmp(ug_flight_probe_env, 1)) {
+		__asm__ __volatile__("mrrc p15, 1, %Q0, %R0, c14" : "=r" (v));
+		ok = v != 0;
+	}
+
+	sigaction(SIGILL, &old, NULL);
+
+	return ok;
+}
+#else
+static int ug_flight_cntvct_probe(void)
+{
+	return 0;
+}
+#endif
+
+/*
+ * A stack overflow leaves no stack to run the handler on: give this
+ * thread one, unless the app already has. Other threads have none.
+ */
+static void ug_flight_altstack(void)
+{
+	stack_t ss;
+
+	if (sigaltstack(NULL, &ss) || !(ss.ss_flags & SS_DISABLE))
+		return;
+
+	ss.ss_sp = malloc(UG_FLIGHT_STACK);
+	if (!ss.ss_sp) {
+		_WRN("flight recorder: no signal stack, no dump on overflow");
+		return;
+	}
+	ss.ss_size = UG_FLIGHT_STACK;
+	ss.ss_flags = 0;
+
+	if (sigaltstack(&ss, NULL)) {
+		_WRN("flight recorder: sigaltstack failed: %s",
+		     strerror(errno));
+		free(ss.ss_sp);
+	}
+}
+
+int ug_flight_init(void)
+{
+	struct sigaction sa;
+	struct sigaction *old;
+	const char *env;
+	unsigned int i;
+	int installed = 0;
+	int force;
+	int signo;
+
+	if (ug_flight.enabled)
+		return 0;
+
+	env = getenv("UG_FLIGHT");
+	if (env && !strcmp(env, "0"))
+		return 0;
+	/* UG_FLIGHT=1: dump ahead of the app's own crash handlers, too */
+	force = env && !strcmp(env, "1");
+
+	/* the pid keeps processes sharing UG_FLIGHT_FILE apart */
+	env = getenv("UG_FLIGHT_FILE");
+	if (env && *env)
+		snprintf(dump.path, sizeof(dump.path), "%s.%d", env, getpid());
+	else
+		snprintf(dump.path, sizeof(dump.path), UG_FLIGHT_FILE_FMT,
+			 getpid());
+	dump.path_len = strlen(dump.path);
+	snprintf(dump.path_seq, sizeof(dump.path_seq), "%s.0", dump.path);
+
+	dump.hdr.magic = UG_FLIGHT_MAGIC;
+	dump.hdr.version = UG_FLIGHT_VERSION;
+	dump.hdr.entry_size = sizeof(struct ug_flight_entry);
+	dump.hdr.n_entries = UG_FLIGHT_ENTRIES;
+	dump.hdr.name_len = UG_FLIGHT_NAME_LEN;
+	dump.hdr.pid = getpid();
+	/* before the first tick, the clock must not change under the ring */
+	ug_flight.cntvct = ug_flight_cntvct_probe();
+	dump.hdr.ticks_start = ug_flight_ticks();
+	dump.hdr.mono_start = ug_flight_mono();
+	dump.n_names = 1;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = ug_flight_signal_handler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = SA_SIGINFO | SA_RESETHAND | SA_ONSTACK;
+
+	for (i = 0; i < sizeof(ug_flight_signals) / sizeof(int); i++) {
+		signo = ug_flight_signals[i];
+		old = &dump.old_actions[signo];
+
+		/* the app's crash handling is its own business */
+		if (sigaction(signo, NULL, old) ||
+		    (!force && ((old->sa_flags & SA_SIGINFO) ||
+				old->sa_handler != SIG_DFL))) {
+			_DBG("flight recorder: signal(%d) is handled", signo);
+			continue;
+		}
+
+		if (sigaction(signo, &sa, NULL)) {
+			_ERR("flight recorder: signal(%d) handler failed", signo);
+			continue;
+		}
+		installed++;
+	}
+
+	if (!installed)
+		return 0;
+
+	ug_flight_altstack();
+
+	ug_flight.enabled = 1;
+	_DBG("flight recorder dumps to %s", dump.path);
+
+	return 0;
+}
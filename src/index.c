@@ -0,0 +1,292 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <linux/limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "ug-index.h"
+#include "ug-dbg.h"
+
+struct ug_index {
+	void *map;
+	size_t size;
+	const struct ug_index_header *hdr;
+	const struct ug_index_dir *dirs;
+	const uint32_t *buckets;
+	const struct ug_index_entry *entries;
+	const char *strings;
+	uint32_t strings_size;
+	const char *pkg_name;
+};
+
+static struct ug_index ug_idx;
+
+static const char *ug_index_str(uint32_t off)
+{
+	if (off >= ug_idx.strings_size)
+		return NULL;
+
+	return ug_idx.strings + off;
+}
+
+static int ug_index_section_valid(uint32_t off, uint32_t count, size_t size)
+{
+	if (off > ug_idx.size)
+		return 0;
+
+	return (uint64_t)count * size <= ug_idx.size - off;
+}
+
+static int ug_index_verify(void)
+{
+	const struct ug_index_header *hdr = ug_idx.hdr;
+
+	if (ug_idx.size < sizeof(*hdr))
+		return 0;
+
+	if (hdr->magic != UG_INDEX_MAGIC || hdr->version != UG_INDEX_VERSION
+	    || hdr->size != ug_idx.size)
+		return 0;
+
+	/* bucket count is a power of two */
+	if (!hdr->n_buckets || (hdr->n_buckets & (hdr->n_buckets - 1)))
+		return 0;
+
+	if (!ug_index_section_valid(hdr->dirs_off, hdr->n_dirs,
+				    sizeof(struct ug_index_dir))
+	    || !ug_index_section_valid(hdr->buckets_off, hdr->n_buckets,
+				       sizeof(uint32_t))
+	    || !ug_index_section_valid(hdr->entries_off, hdr->n_entries,
+				       sizeof(struct ug_index_entry))
+	    || hdr->strings_off >= ug_idx.size)
+		return 0;
+
+	/* string table must be terminated so lookups can't run off the map */
+	if (((const char *)ug_idx.map)[ug_idx.size - 1] != '\0')
+		return 0;
+
+	ug_idx.dirs = (const void *)((const char *)ug_idx.map + hdr->dirs_off);
+	ug_idx.buckets = (const void *)((const char *)ug_idx.map +
+					hdr->buckets_off);
+	ug_idx.entries = (const void *)((const char *)ug_idx.map +
+					hdr->entries_off);
+	ug_idx.strings = (const char *)ug_idx.map + hdr->strings_off;
+	ug_idx.strings_size = ug_idx.size - hdr->strings_off;
+
+	return 1;
+}
+
+static int64_t ug_index_dir_mtime(const char *path)
+{
+	struct stat st;
+
+	if (stat(path, &st) || !S_ISDIR(st.st_mode))
+		return -1;
+
+	return (int64_t)st.st_mtim.tv_sec * 1000000000 +
+			st.st_mtim.tv_nsec;
+}
+
+static const struct ug_index_dir *ug_index_dir_find(const char *path)
+{
+	const struct ug_index_dir *d;
+	const char *p;
+	uint32_t i;
+
+	for (i = 0; i < ug_idx.hdr->n_dirs; i++) {
+		d = &ug_idx.dirs[i];
+		p = ug_index_str(d->path);
+		if (p && !strcmp(p, path))
+			return d;
+	}
+
+	return NULL;
+}
+
+/* only the directories this process can load from are checked */
+static int ug_index_is_fresh(void)
+{
+	const char *roots[] = UG_INDEX_PKG_ROOTS;
+	const struct ug_index_dir *d;
+	const char *path;
+	const char *pkg;
+	char dir[PATH_MAX];
+	unsigned int i;
+
+	for (i = 0; i < ug_idx.hdr->n_dirs; i++) {
+		d = &ug_idx.dirs[i];
+		path = ug_index_str(d->path);
+		pkg = ug_index_str(d->pkg);
+		if (!path || !pkg)
+			return 0;
+
+		if (pkg[0] && (!ug_idx.pkg_name || strcmp(pkg, ug_idx.pkg_name)))
+			continue;
+
+		if (ug_index_dir_mtime(path) != d->mtime) {
+			_DBG("index stale: %s changed", path);
+			return 0;
+		}
+	}
+
+	if (!ug_idx.pkg_name)
+		return 1;
+
+	/* a package lib dir created after the index was built */
+	for (i = 0; i < sizeof(roots) / sizeof(roots[0]); i++) {
+		snprintf(dir, PATH_MAX, "%s/%s/lib", roots[i], ug_idx.pkg_name);
+		if (!ug_index_dir_find(dir) && ug_index_dir_mtime(dir) != -1) {
+			_DBG("index stale: %s is not indexed", dir);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+int ug_index_open(const char *path, const char *pkg_name)
+{
+	struct stat st;
+	void *map;
+	int fd;
+
+	if (ug_idx.map)
+		return 0;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		_DBG("index %s is not available: %s", path, strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) || st.st_size <= 0) {
+		close(fd);
+		return -1;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		_ERR("index mmap failed: %s", strerror(errno));
+		return -1;
+	}
+
+	ug_idx.map = map;
+	ug_idx.size = st.st_size;
+	ug_idx.hdr = map;
+	ug_idx.pkg_name = pkg_name;
+
+	if (!ug_index_verify()) {
+		_ERR("index %s is corrupted", path);
+		ug_index_close();
+		return -1;
+	}
+
+	if (!ug_index_is_fresh()) {
+		_WRN("index %s is stale, fall back to probing", path);
+		ug_index_close();
+		return -1;
+	}
+
+	_DBG("index %s: %u gadgets", path, ug_idx.hdr->n_entries);
+
+	return 0;
+}
+
+void ug_index_close(void)
+{
+	if (ug_idx.map)
+		munmap(ug_idx.map, ug_idx.size);
+
+	memset(&ug_idx, 0, sizeof(ug_idx));
+}
+
+/* the library the entry was made from is still there and unchanged */
+static int ug_index_entry_is_fresh(const struct ug_index_entry *e,
+				   const char *path)
+{
+	struct stat st;
+
+	if (stat(path, &st) || (uint64_t)st.st_size != e->size ||
+	    (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec !=
+	    e->mtime) {
+		_DBG("index stale: %s changed", path);
+		return 0;
+	}
+
+	return 1;
+}
+
+int ug_index_lookup(const char *name, const char **path)
+{
+	const struct ug_index_entry *e;
+	const struct ug_index_entry *best = NULL;
+	const char *e_name;
+	const char *e_pkg;
+	uint32_t h;
+	uint32_t i;
+	uint32_t n;
+
+	if (!ug_idx.map)
+		return -1;
+
+	h = ug_index_hash(name);
+	i = ug_idx.buckets[h & (ug_idx.hdr->n_buckets - 1)];
+
+	for (n = 0; i && i <= ug_idx.hdr->n_entries
+		    && n < ug_idx.hdr->n_entries; n++) {
+		e = &ug_idx.entries[i - 1];
+		i = e->next;
+
+		if (e->hash != h)
+			continue;
+
+		e_name = ug_index_str(e->name);
+		e_pkg = ug_index_str(e->pkg);
+		if (!e_name || !e_pkg || strcmp(e_name, name))
+			continue;
+
+		/* other packages' private gadgets are not visible */
+		if (e_pkg[0] && (!ug_idx.pkg_name
+				 || strcmp(e_pkg, ug_idx.pkg_name)))
+			continue;
+
+		if (!best || e->rank < best->rank)
+			best = e;
+	}
+
+	if (!best)
+		return 0;
+
+	*path = ug_index_str(best->path);
+	if (!*path)
+		return 0;
+
+	return ug_index_entry_is_fresh(best, *path) ? 1 : -1;
+}
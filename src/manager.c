@@ -33,12 +33,21 @@
 #include "ug.h"
 #include "ug-manager.h"
 #include "ug-engine.h"
+#include "ug-stats.h"
+#include "ug-probe.h"
+#include "ug-op.h"
+#include "ug-trace.h"
+#include "ug-sched.h"
+#include "ug-perf.h"
+#include "ug-prof.h"
 #include "ug-dbg.h"
 
 struct ug_manager {
 	ui_gadget_h root;
 	ui_gadget_h fv_top;
-	GSList *fv_list;
+
+	/* every ug linked into the tree, for O(1) handle validation */
+	GHashTable *live;
 
 	void *win;
 	Window win_id;
@@ -48,11 +57,23 @@ struct ug_manager {
 	enum ug_option base_opt;
 	enum ug_event last_rotate_evt;
 
+	/*
+	 * events not delivered yet, one slot per event class: a newer
+	 * rotation replaces an older one, repeated events collapse
+	 */
+	enum ug_event pending_evt[UG_EVENT_MAX];
+	/* when each slot was last posted to, events go out in this order */
+	unsigned int pending_seq[UG_EVENT_MAX];
+	unsigned int event_seq;
+	/* 1 << enum ug_sched_prio, for each event job queued and not run */
+	unsigned int event_jobs;
+
 	int walking;
 
 	int is_initted:1;
 	int is_landscape:1;
 	int destroy_all:1;
+	int tree_dump:1;
 
 	struct ug_engine *engine;
 };
@@ -62,12 +83,61 @@ static struct ug_manager ug_man;
 static inline void job_start(void);
 static inline void job_end(void);
 
+static unsigned int ug_event_mask_get(ui_gadget_h ug)
+{
+	struct ug_module_ops *ops;
+
+	if (!ug->module)
+		return 0;
+
+	ops = &ug->module->ops;
+	if (!ops->event)
+		return 0;
+
+	return ops->event_mask ? ops->event_mask : UG_EVENT_MASK_ALL;
+}
+
+/* recompute the subtree masks from ug up, until one does not change */
+static void ug_event_mask_update(ui_gadget_h ug)
+{
+	ui_gadget_h child;
+	unsigned int mask;
+
+	for (; ug; ug = ug->parent) {
+		mask = ug->event_mask;
+		for (child = ug->first_child; child; child = child->next_sibling)
+			mask |= child->subtree_event_mask;
+
+		if (mask == ug->subtree_event_mask)
+			break;
+		ug->subtree_event_mask = mask;
+	}
+}
+
 static int ug_relation_add(ui_gadget_h p, ui_gadget_h c)
 {
+	ui_gadget_h a;
+
 	c->parent = p;
-	/* prepend element to avoid the inefficiency,
-		which is to traverse the entire list to find the end*/
-	p->children = g_slist_prepend(p->children, c);
+	/* newest child first, as the traversal order expects */
+	c->prev_sibling = NULL;
+	c->next_sibling = p->first_child;
+	if (p->first_child)
+		p->first_child->prev_sibling = c;
+	else
+		p->last_child = c;
+	p->first_child = c;
+	g_hash_table_insert(ug_man.live, c, c);
+	ug_metrics_node_parent(c);
+
+	c->event_mask = ug_event_mask_get(c);
+	c->subtree_event_mask |= c->event_mask;
+	for (a = p; a; a = a->parent) {
+		if ((a->subtree_event_mask & c->subtree_event_mask)
+		    == c->subtree_event_mask)
+			break;
+		a->subtree_event_mask |= c->subtree_event_mask;
+	}
 
 	return 0;
 }
@@ -81,17 +151,81 @@ static int ug_relation_del(ui_gadget_h ug)
 		_ERR("ug_relation_del failed: no parent");
 		return -1;
 	}
-	p->children = g_slist_remove(p->children, ug);
-	if (ug->children)
-		g_slist_free(ug->children);
+	if (ug->prev_sibling)
+		ug->prev_sibling->next_sibling = ug->next_sibling;
+	else
+		p->first_child = ug->next_sibling;
+	if (ug->next_sibling)
+		ug->next_sibling->prev_sibling = ug->prev_sibling;
+	else
+		p->last_child = ug->prev_sibling;
+
+	g_hash_table_remove(ug_man.live, ug);
 	ug->parent = NULL;
+	ug->next_sibling = NULL;
+	ug->prev_sibling = NULL;
+
+	ug_event_mask_update(p);
 
 	return 0;
 }
 
+/*
+ * Follows the parent and sibling links instead of recursing, so deep
+ * trees cannot overflow the stack. The next gadget is read before post
+ * runs, as post may unlink and free the one it is given.
+ */
+UG_INTERNAL_API void ug_tree_walk(ui_gadget_h top, ug_tree_pre_cb pre,
+				  ug_tree_post_cb post, void *data)
+{
+	ui_gadget_h ug = top;
+	ui_gadget_h next;
+	ui_gadget_h parent;
+	int skip;
+	int last;
+
+	if (!ug)
+		return;
+
+	for (;;) {
+		skip = pre && !pre(ug, data);
+		if (!skip && ug->first_child) {
+			ug = ug->first_child;
+			continue;
+		}
+
+		/* the subtree of ug is done, climb until a sibling is left */
+		for (;;) {
+			last = ug == top;
+			next = ug->next_sibling;
+			parent = ug->parent;
+
+			if (!skip && post)
+				post(ug, data);
+			if (last)
+				return;
+			if (next)
+				break;
+
+			ug = parent;
+			skip = 0;
+		}
+
+		ug = next;
+	}
+}
+
+static int ug_fvlist_has(ui_gadget_h c)
+{
+	return c == ug_man.fv_top || c->fv_above;
+}
+
 static int ug_fvlist_add(ui_gadget_h c)
 {
-	ug_man.fv_list = g_slist_prepend(ug_man.fv_list, c);
+	c->fv_above = NULL;
+	c->fv_below = ug_man.fv_top;
+	if (ug_man.fv_top)
+		ug_man.fv_top->fv_above = c;
 	ug_man.fv_top = c;
 
 	return 0;
@@ -99,13 +233,20 @@ static int ug_fvlist_add(ui_gadget_h c)
 
 static int ug_fvlist_del(ui_gadget_h c)
 {
-	ui_gadget_h t;
-
-	ug_man.fv_list = g_slist_remove(ug_man.fv_list, c);
+	if (!ug_fvlist_has(c))
+		return 0;
 
 	/* update fullview top ug*/
-	t = g_slist_nth_data(ug_man.fv_list, 0);
-	ug_man.fv_top = t;
+	if (c->fv_above)
+		c->fv_above->fv_below = c->fv_below;
+	else
+		ug_man.fv_top = c->fv_below;
+
+	if (c->fv_below)
+		c->fv_below->fv_above = c->fv_above;
+
+	c->fv_above = NULL;
+	c->fv_below = NULL;
 
 	return 0;
 }
@@ -203,60 +344,43 @@ func_out:
 	return func_ret;
 }
 
-static void ugman_tree_dump(ui_gadget_h ug)
+#ifndef UG_DISABLE_DEBUG_LOG
+static int ugman_tree_dump_pre(ui_gadget_h ug, void *data)
 {
-	static int i;
-	int lv;
-	const char *name;
-	GSList *child;
-	ui_gadget_h c;
-
-	if (!ug)
-		return;
+	ui_gadget_h p;
+	int lv = 0;
 
-	name = ug->name;
 	if (ug == ug_man.root) {
-		i = 0;
 		_DBG("============== TREE_DUMP =============");
 		_DBG("ROOT: Manager");
-		name = "Manager";
+		return 1;
 	}
 
-	child = ug->children;
-	if (!child)
-		return;
+	for (p = ug->parent; p; p = p->parent)
+		lv++;
 
-	i++;
-	lv = i;
+	_DBG("[%d] %s [%c] (%p) (PARENT:  %s)",
+	     lv,
+	     ug->name ? ug->name : "NO CHILD INFO FIXIT!!!",
+	     ug->mode == UG_MODE_FULLVIEW ? 'F' : 'f', ug,
+	     ug->parent == ug_man.root ? "Manager" : ug->parent->name);
 
-	while (child) {
-		c = child->data;
-		_DBG("[%d] %s [%c] (%p) (PARENT:  %s)",
-		     lv,
-		     c && c->name ? c->name : "NO CHILD INFO FIXIT!!!",
-		     c && c->mode == UG_MODE_FULLVIEW ? 'F' : 'f', c, name);
-		ugman_tree_dump(c);
-		child = g_slist_next(child);
-	}
+	return 1;
 }
 
-static int ugman_ug_find(ui_gadget_h p, ui_gadget_h ug)
+static void ugman_tree_dump(ui_gadget_h ug)
 {
-	GSList *child = NULL;
-
-	if (!p || !ug)
-		return 0;
-	child = p->children;
-
-	while (child) {
-		if (child->data == ug)
-			return 1;
-		if (ugman_ug_find(child->data, ug))
-			return 1;
-		child = g_slist_next(child);
-	}
+	ug_tree_walk(ug, ugman_tree_dump_pre, NULL, NULL);
+}
+#endif
 
-	return 0;
+/* the tree is only walked for a dump when UG_TREE_DUMP asks for it */
+static void ugman_tree_dump_on_demand(void)
+{
+#ifndef UG_DISABLE_DEBUG_LOG
+	if (ug_man.tree_dump && ug_log_level >= UG_LOG_LEVEL_DEBUG)
+		ugman_tree_dump(ug_man.root);
+#endif
 }
 
 static void ugman_ug_start(void *data)
@@ -274,88 +398,94 @@ static void ugman_ug_start(void *data)
 
 	_DBG("ug=%p", ug);
 
-	ug->state = UG_STATE_RUNNING;
+	ug_state_set(ug, UG_STATE_RUNNING);
+	ug_stats_mark(ug, UG_STATS_EDGE_STARTED);
+	UG_PROBE(start, ug);
 
 	if (ug->module)
 		ops = &ug->module->ops;
 
-	if (ops && ops->start)
+	if (ops && ops->start) {
+		ug_op_enter(ug, UG_OP_START);
 		ops->start(ug, ug->service, ops->priv);
+		ug_op_leave(ug, UG_OP_START);
+	}
 
 	return;
 }
 
-static int ugman_ug_pause(void *data)
+static int ugman_ug_pause_pre(ui_gadget_h ug, void *data)
 {
-	ui_gadget_h ug = data;
-	struct ug_module_ops *ops = NULL;
-	GSList *child = NULL;
-
-	job_start();
+	if (ug->state != UG_STATE_RUNNING)
+		return 0;
 
-	if (!ug || ug->state != UG_STATE_RUNNING)
-		goto end;
+	ug_state_set(ug, UG_STATE_STOPPED);
+	UG_PROBE(pause, ug);
 
-	ug->state = UG_STATE_STOPPED;
+	return 1;
+}
 
-	if (ug->children) {
-		child = ug->children;
-		while (child) {
-			ugman_ug_pause(child->data);
-			child = g_slist_next(child);
-		}
-	}
+static void ugman_ug_pause_post(ui_gadget_h ug, void *data)
+{
+	struct ug_module_ops *ops = NULL;
 
 	if (ug->module)
 		ops = &ug->module->ops;
 
-	if (ops && ops->pause)
+	if (ops && ops->pause) {
+		ug_op_enter(ug, UG_OP_PAUSE);
 		ops->pause(ug, ug->service, ops->priv);
-
- end:
-	job_end();
-	return 0;
+		ug_op_leave(ug, UG_OP_PAUSE);
+	}
 }
 
-static int ugman_ug_resume(void *data)
+static int ugman_ug_pause(void *data)
 {
-	ui_gadget_h ug = data;
-	struct ug_module_ops *ops = NULL;
-	GSList *child = NULL;
-
 	job_start();
+	ug_tree_walk(data, ugman_ug_pause_pre, ugman_ug_pause_post, NULL);
+	job_end();
 
-	if (!ug)
-		goto end;
+	return 0;
+}
 
+static int ugman_ug_resume_pre(ui_gadget_h ug, void *data)
+{
 	switch (ug->state) {
 	case UG_STATE_CREATED:
 		ugman_ug_start(ug);
-		goto end;
+		return 0;
 	case UG_STATE_STOPPED:
 		break;
 	default:
-		goto end;
+		return 0;
 	}
 
-	ug->state = UG_STATE_RUNNING;
+	ug_state_set(ug, UG_STATE_RUNNING);
+	UG_PROBE(resume, ug);
 
-	if (ug->children) {
-		child = ug->children;
-		while (child) {
-			ugman_ug_resume(child->data);
-			child = g_slist_next(child);
-		}
-	}
+	return 1;
+}
+
+static void ugman_ug_resume_post(ui_gadget_h ug, void *data)
+{
+	struct ug_module_ops *ops = NULL;
 
 	if (ug->module)
 		ops = &ug->module->ops;
 
-	if (ops && ops->resume)
+	if (ops && ops->resume) {
+		ug_op_enter(ug, UG_OP_RESUME);
 		ops->resume(ug, ug->service, ops->priv);
+		ug_op_leave(ug, UG_OP_RESUME);
+	}
+}
 
- end:
+static int ugman_ug_resume(void *data)
+{
+	job_start();
+	ug_tree_walk(data, ugman_ug_resume_pre, ugman_ug_resume_post, NULL);
 	job_end();
+
 	return 0;
 }
 
@@ -430,44 +560,61 @@ static int ugman_ug_getopt(ui_gadget_h ug)
 	return 0;
 }
 
-static int ugman_ug_event(ui_gadget_h ug, enum ug_event event)
+struct ug_event_batch {
+	const enum ug_event *events;
+	int count;
+	/* UG_EVENT_MASK() bits of events[] */
+	unsigned int mask;
+};
+
+static int ugman_ug_events_pre(ui_gadget_h ug, void *data)
 {
-	struct ug_module_ops *ops = NULL;
-	GSList *child = NULL;
+	struct ug_event_batch *b = data;
 
-	if (!ug)
-		return 0;
+	return (ug->subtree_event_mask & b->mask) != 0;
+}
 
-	if (ug->children) {
-		child = ug->children;
-		while (child) {
-			ugman_ug_event(child->data, event);
-			child = g_slist_next(child);
-		}
-	}
+static void ugman_ug_events_post(ui_gadget_h ug, void *data)
+{
+	struct ug_event_batch *b = data;
+	struct ug_module_ops *ops = NULL;
+	int i;
 
 	if (ug->module)
 		ops = &ug->module->ops;
 
-	_DBG("ug_event_cb : ug(%p) / event(%d)", ug, event);
+	for (i = 0; i < b->count; i++) {
+		if (!(ug->event_mask & UG_EVENT_MASK(b->events[i])))
+			continue;
 
-	if (ops && ops->event)
-		ops->event(ug, event, ug->service, ops->priv);
+		UG_PROBE1(event, ug, b->events[i]);
+		_DBG("ug_event_cb : ug(%p) / event(%d)", ug, b->events[i]);
 
-	return 0;
+		if (ops && ops->event) {
+			ug_op_enter(ug, UG_OP_EVENT);
+			ops->event(ug, b->events[i], ug->service, ops->priv);
+			ug_op_leave(ug, UG_OP_EVENT);
+		}
+	}
 }
 
-static int ugman_ug_destroy(void *data)
+static int ugman_ug_events(ui_gadget_h ug, const enum ug_event *events,
+			   int count, unsigned int mask)
 {
-	ui_gadget_h ug = data;
-	struct ug_module_ops *ops = NULL;
-	GSList *child, *trail;
+	struct ug_event_batch b = { events, count, mask };
 
-	job_start();
+	ug_tree_walk(ug, ugman_ug_events_pre, ugman_ug_events_post, &b);
 
-	if (!ug)
-		goto end;
+	return 0;
+}
 
+static int ugman_ug_event(ui_gadget_h ug, enum ug_event event)
+{
+	return ugman_ug_events(ug, &event, 1, UG_EVENT_MASK(event));
+}
+
+static int ugman_ug_destroy_pre(ui_gadget_h ug, void *data)
+{
 	_DBG("ugman_ug_destroy ug(%p) state(%d)", ug, ug->state);
 
 	switch (ug->state) {
@@ -477,20 +624,25 @@ static int ugman_ug_destroy(void *data)
 	case UG_STATE_DESTROYING:
 		break;
 	default:
-		goto end;
+		return 0;
 	}
 
-	ug->state = UG_STATE_DESTROYED;
+	UG_PROBE(destroy, ug);
+	ug_state_set(ug, UG_STATE_DESTROYED);
 
-	if (ug->children) {
-		child = ug->children;
-		_DBG("ug_destroy ug(%p) has child(%p)", ug, child->data);
-		while (child) {
-			trail = g_slist_next(child);
-			ugman_ug_destroy(child->data);
-			child = trail;
-		}
-	}
+	/* ug_destroy_all() does not go through ugman_ug_destroying() */
+	if (!ug->stats.edges[UG_STATS_EDGE_DESTROY_REQUESTED])
+		ug_stats_mark(ug, UG_STATS_EDGE_DESTROY_REQUESTED);
+
+	if (ug->first_child)
+		_DBG("ug_destroy ug(%p) has child(%p)", ug, ug->first_child);
+
+	return 1;
+}
+
+static void ugman_ug_destroy_post(ui_gadget_h ug, void *data)
+{
+	struct ug_module_ops *ops = NULL;
 
 	if((ug != ug_man.root) && (ug->layout) &&
 		(ug->layout_state != UG_LAYOUT_DESTROY)) {
@@ -500,8 +652,13 @@ static int ugman_ug_destroy(void *data)
 		if (ug_man.engine)
 			eng_ops = &ug_man.engine->ops;
 
-		if (eng_ops && eng_ops->destroy)
+		if (eng_ops && eng_ops->destroy) {
+			UG_TRACE_BEGIN(UG_TRACE_CAT_ENGINE, "engine_destroy", ug);
+			UG_PROF_ENTER(ug, "engine_destroy");
 			eng_ops->destroy(ug, NULL, NULL);
+			UG_PROF_LEAVE();
+			UG_TRACE_END(UG_TRACE_CAT_ENGINE, "engine_destroy", ug);
+		}
 	}
 
 	if (ug->module)
@@ -509,7 +666,9 @@ static int ugman_ug_destroy(void *data)
 
 	if (ops && ops->destroy) {
 		_DBG("ug(%p) module destory cb call", ug);
+		ug_op_enter(ug, UG_OP_DESTROY);
 		ops->destroy(ug, ug->service, ops->priv);
+		ug_op_leave(ug, UG_OP_DESTROY);
 	}
 
 	if (ug != ug_man.root)
@@ -524,14 +683,30 @@ static int ugman_ug_destroy(void *data)
 		}
 	}
 
+	if (ug != ug_man.root) {
+		ug_stats_mark(ug, UG_STATS_EDGE_DESTROYED);
+		ug_stats_fold(ug);
+		UG_METRICS_INC(destroys);
+	}
+
 	_DBG("free ug(%p)", ug);
 	ug_free(ug);
 
-	if (ug_man.root == ug)
+	if (ug_man.root == ug) {
 		ug_man.root = NULL;
+		memset(ug_man.pending_evt, 0, sizeof(ug_man.pending_evt));
+		/* the tree is gone, a good time to write the trace out */
+		ug_trace_flush();
+		ug_perf_dump();
+		ug_prof_dump();
+	}
+}
 
-	ugman_tree_dump(ug_man.root);
- end:
+static int ugman_ug_destroy(void *data)
+{
+	job_start();
+	ug_tree_walk(data, ugman_ug_destroy_pre, ugman_ug_destroy_post, NULL);
+	ugman_tree_dump_on_demand();
 	job_end();
 
 	return 0;
@@ -540,7 +715,10 @@ static int ugman_ug_destroy(void *data)
 static void ug_hide_end_cb(void *data)
 {
 	ui_gadget_h ug = data;
-	ecore_idler_add((Ecore_Task_Cb)ugman_ug_destroy, ug);
+
+	ug_stats_mark(ug, UG_STATS_EDGE_HIDE_END);
+	ug_sched_add(UG_SCHED_BACKGROUND, (Ecore_Task_Cb)ugman_ug_destroy, ug,
+		     "ug_destroy");
 }
 
 static int ugman_ug_create(void *data)
@@ -555,7 +733,9 @@ static int ugman_ug_create(void *data)
 		return -1;
 	}
 
-	ug->state = UG_STATE_CREATED;
+	ug_state_set(ug, UG_STATE_CREATED);
+	UG_METRICS_INC(creates);
+	UG_PROBE(create, ug);
 
 	if (ug->module)
 		ops = &ug->module->ops;
@@ -564,7 +744,10 @@ static int ugman_ug_create(void *data)
 		eng_ops = &ug_man.engine->ops;
 
 	if (ops && ops->create) {
+		ug_op_enter(ug, UG_OP_CREATE);
 		ug->layout = ops->create(ug, ug->mode, ug->service, ops->priv);
+		ug_op_leave(ug, UG_OP_CREATE);
+		ug_stats_mark(ug, UG_STATS_EDGE_CREATED);
 		if (!ug->layout) {
 			ug_relation_del(ug);
 			_ERR("ug(%p) layout is null", ug);
@@ -573,13 +756,18 @@ static int ugman_ug_create(void *data)
 		if (ug->mode == UG_MODE_FULLVIEW) {
 			if (eng_ops && eng_ops->create) {
 				//change start cb function call after transition,finished for fullview
+				UG_TRACE_BEGIN(UG_TRACE_CAT_ENGINE, "engine_create", ug);
+				UG_PROF_ENTER(ug, "engine_create");
 				ug_man.conform = eng_ops->create(ug_man.win, ug, ugman_ug_start);
+				UG_PROF_LEAVE();
+				UG_TRACE_END(UG_TRACE_CAT_ENGINE, "engine_create", ug);
 			}
 		}
 		cbs = &ug->cbs;
 
 		if (cbs && cbs->layout_cb)
 			cbs->layout_cb(ug, ug->mode, cbs->priv);
+		ug_stats_mark(ug, UG_STATS_EDGE_LAYOUT_DONE);
 
 		_DBG("after caller layout cb call");
 		ugman_indicator_update(ug->opt, UG_EVENT_NONE);
@@ -593,7 +781,7 @@ static int ugman_ug_create(void *data)
 	if(ug->mode == UG_MODE_FRAMEVIEW)
 		ugman_ug_start(ug);
 
-	ugman_tree_dump(ug_man.root);
+	ugman_tree_dump_on_demand();
 
 	return 0;
 }
@@ -654,19 +842,28 @@ ui_gadget_h ugman_ug_load(ui_gadget_h parent,
 		return NULL;
 	}
 
+	ug_stats_mark(ug, UG_STATS_EDGE_LOAD_REQUESTED);
+
+	ug->name = strdup(name);
+	ug->flight_name = ug_flight_name(ug->name);
+	ug_metrics_node_add(ug);
+	ug_flight_mark(ug, UG_FLIGHT_OP_LOAD);
+	UG_PROBE(load, ug);
+
+	UG_TRACE_BEGIN(UG_TRACE_CAT_MODULE, "load", ug);
 	ug->module = ug_module_load(name);
+	UG_TRACE_END(UG_TRACE_CAT_MODULE, "load", ug);
 	if (!ug->module) {
 		_ERR("ug_create() failed: Module loading failed");
 		goto load_fail;
 	}
 
-	ug->name = strdup(name);
+	ug_stats_mark(ug, UG_STATS_EDGE_MODULE_LOADED);
 
 	ug->mode = mode;
 	service_clone(&ug->service, service);
 	ug->opt = ug->module->ops.opt;
-	ug->state = UG_STATE_READY;
-	ug->children = NULL;
+	ug_state_set(ug, UG_STATE_READY);
 
 	if (cbs)
 		memcpy(&ug->cbs, cbs, sizeof(struct ug_cbs));
@@ -684,28 +881,154 @@ ui_gadget_h ugman_ug_load(ui_gadget_h parent,
 	return NULL;
 }
 
-int ugman_ug_destroying(ui_gadget_h ug)
+struct ug_async_req {
+	ui_gadget_h parent;
+	char *name;
+	enum ug_mode mode;
+	service_h service;
+	struct ug_cbs cbs;
+	void *handle;
+	unsigned long long requested;
+};
+
+static void ug_async_req_free(struct ug_async_req *req)
 {
-	struct ug_module_ops *ops = NULL;
-	GSList *child, *trail;
+	ug_module_prefetch_release(req->handle);
+	if (req->service)
+		service_destroy(req->service);
+	free(req->name);
+	free(req);
+}
+
+static void ug_async_load(void *data, Ecore_Thread *thread)
+{
+	struct ug_async_req *req = data;
+
+	/* worker thread: path resolution, readahead and dlopen only */
+	UG_TRACE_BEGIN(UG_TRACE_CAT_MODULE, "prefetch", NULL);
+	req->handle = ug_module_prefetch(req->name);
+	UG_TRACE_END(UG_TRACE_CAT_MODULE, "prefetch", NULL);
+}
+
+static void ug_async_load_end(void *data, Ecore_Thread *thread)
+{
+	struct ug_async_req *req = data;
+	ui_gadget_h ug = NULL;
+
+	/*
+	 * A parent on its way out would orphan the child, or tear it down
+	 * in the middle of its creation.
+	 */
+	if (req->parent && !ugman_ug_exist(req->parent)) {
+		_ERR("ug_create_async() failed: parent(%p) is gone",
+		     req->parent);
+	} else if (req->parent && req->parent->destroy_me) {
+		_ERR("ug_create_async() failed: parent(%p) is being destroyed",
+		     req->parent);
+	} else if (!ug_man.is_initted) {
+		_ERR("ug_create_async() failed: manager is not initted");
+	} else {
+		/* the library is resident now, this only runs module init */
+		ug = ugman_ug_load(req->parent, req->name, req->mode,
+				   req->service, &req->cbs);
+	}
 
+	/* the request was made before the worker ran */
+	if (ug)
+		ug->stats.edges[UG_STATS_EDGE_LOAD_REQUESTED] = req->requested;
+
+	_DBG("ug_create_async(%s) done: ug(%p)", req->name, ug);
+
+	if (req->cbs.create_cb)
+		req->cbs.create_cb(ug, ug ? 0 : -1, req->cbs.priv);
+
+	ug_async_req_free(req);
+}
+
+static void ug_async_load_cancel(void *data, Ecore_Thread *thread)
+{
+	struct ug_async_req *req = data;
+
+	_ERR("ug_create_async(%s) failed: loading is cancelled", req->name);
+
+	if (req->cbs.create_cb)
+		req->cbs.create_cb(NULL, -1, req->cbs.priv);
+
+	ug_async_req_free(req);
+}
+
+int ugman_ug_load_async(ui_gadget_h parent,
+				const char *name,
+				enum ug_mode mode,
+				service_h service, struct ug_cbs *cbs)
+{
+	struct ug_async_req *req;
+
+	if (!ug_man.is_initted) {
+		_ERR("ug_create_async() failed: manager is not initted");
+		return -1;
+	}
+
+	if (parent && (!ugman_ug_exist(parent) || parent->destroy_me)) {
+		_ERR("ug_create_async() failed: Invalid parent");
+		errno = EINVAL;
+		return -1;
+	}
+
+	req = calloc(1, sizeof(struct ug_async_req));
+	if (!req) {
+		_ERR("ug_create_async() failed: Memory allocation failed");
+		return -1;
+	}
+
+	req->name = strdup(name);
+	if (!req->name) {
+		free(req);
+		return -1;
+	}
+
+	req->requested = ug_stats_now();
+	req->parent = parent;
+	req->mode = mode;
+	if (service)
+		service_clone(&req->service, service);
+	if (cbs)
+		memcpy(&req->cbs, cbs, sizeof(struct ug_cbs));
+
+	/* func_cancel also reports a thread that could not be started */
+	ecore_thread_run(ug_async_load, ug_async_load_end,
+			 ug_async_load_cancel, req);
+
+	return 0;
+}
+
+static int ugman_ug_destroying_pre(ui_gadget_h ug, void *data)
+{
 	ug->destroy_me = 1;
-	ug->state = UG_STATE_DESTROYING;
+	ug_state_set(ug, UG_STATE_DESTROYING);
+	ug_stats_mark(ug, UG_STATS_EDGE_DESTROY_REQUESTED);
+
+	return 1;
+}
+
+static void ugman_ug_destroying_post(ui_gadget_h ug, void *data)
+{
+	struct ug_module_ops *ops = NULL;
 
 	if (ug->module)
 		ops = &ug->module->ops;
 
-	if (ug->children) {
-		child = ug->children;
-		while (child) {
-			trail = g_slist_next(child);
-			ugman_ug_destroying(child->data);
-			child = trail;
-		}
+	if (ops && ops->destroying) {
+		ug_op_enter(ug, UG_OP_DESTROYING);
+		ops->destroying(ug, ug->service, ops->priv);
+		ug_op_leave(ug, UG_OP_DESTROYING);
 	}
+}
 
-	if (ops && ops->destroying)
-		ops->destroying(ug, ug->service, ops->priv);
+int ugman_ug_destroying(ui_gadget_h ug)
+{
+	ug_tree_walk(ug, ugman_ug_destroying_pre, ugman_ug_destroying_post,
+		     NULL);
 
 	return 0;
 }
@@ -737,6 +1060,9 @@ int ugman_ug_del(ui_gadget_h ug)
 		return -1;
 	}
 
+	ug_flight_mark(ug, UG_FLIGHT_OP_DEL);
+	UG_PROBE(del, ug);
+
 	ugman_ug_destroying(ug);
 
 	/* pre call for indicator update time issue */
@@ -744,17 +1070,11 @@ int ugman_ug_del(ui_gadget_h ug)
 	ui_gadget_h t = NULL;
 	if (ug_man.fv_top == ug) {
 		is_update = true;
-		t = g_slist_nth_data(ug_man.fv_list, 1);
-	} else {
-		if (ug->children) {
-			GSList *child;
-			child = g_slist_last(ug->children);
-			if(ug_man.fv_top == (ui_gadget_h)child->data) {
-				is_update = true;
-				t = g_slist_nth_data(ug_man.fv_list,
-					g_slist_index(ug_man.fv_list,(gconstpointer)ug)+1);
-			}
-		}
+		t = ug->fv_below;
+	} else if (ug->last_child && ug_man.fv_top == ug->last_child) {
+		is_update = true;
+		/* a gadget off the stack falls back to the top, as before */
+		t = ug_fvlist_has(ug) ? ug->fv_below : ug_man.fv_top;
 	}
 	if((is_update)&&(t)) {
 		ugman_ug_getopt(t);
@@ -763,14 +1083,19 @@ int ugman_ug_del(ui_gadget_h ug)
 	if (ug_man.engine)
 		eng_ops = &ug_man.engine->ops;
 
-	if (eng_ops && eng_ops->destroy)
+	if (eng_ops && eng_ops->destroy) {
+		UG_TRACE_BEGIN(UG_TRACE_CAT_ENGINE, "engine_destroy", ug);
+		UG_PROF_ENTER(ug, "engine_destroy");
 		if (ug->mode == UG_MODE_FULLVIEW)
 			eng_ops->destroy(ug, ug_man.fv_top, ug_hide_end_cb);
 		else {
 			eng_ops->destroy(ug, NULL, ug_hide_end_cb);
 		}
-	else
-		ecore_idler_add((Ecore_Task_Cb)ugman_ug_destroy, ug);
+		UG_PROF_LEAVE();
+		UG_TRACE_END(UG_TRACE_CAT_ENGINE, "engine_destroy", ug);
+	} else
+		ug_sched_add(UG_SCHED_BACKGROUND,
+			     (Ecore_Task_Cb)ugman_ug_destroy, ug, "ug_destroy");
 
 	return 0;
 }
@@ -800,14 +1125,24 @@ int ugman_ug_del_all(void)
 
 int ugman_init(Display *disp, Window xid, void *win, enum ug_option opt)
 {
+	if (!ug_man.live)
+		ug_man.live = g_hash_table_new(g_direct_hash, g_direct_equal);
+	if (!ug_man.live) {
+		_ERR("ugman_init failed: live table create failed");
+		return -1;
+	}
+
 	ug_man.is_initted = 1;
 	ug_man.win = win;
 	ug_man.disp = disp;
 	ug_man.win_id = xid;
 	ug_man.base_opt = opt;
 	ug_man.last_rotate_evt = UG_EVENT_NONE;
+	ug_man.tree_dump = getenv("UG_TREE_DUMP") ? 1 : 0;
 	ug_man.engine = ug_engine_load();
 
+	ug_module_init();
+
 	return 0;
 }
 
@@ -826,7 +1161,9 @@ int ugman_resume(void)
 
 	_DBG("ugman_resume called");
 
-	ecore_idler_add((Ecore_Task_Cb)ugman_ug_resume, ug_man.root);
+	/* same priority as pause, so the two run in call order */
+	ug_sched_add(UG_SCHED_URGENT, (Ecore_Task_Cb)ugman_ug_resume,
+		     ug_man.root, "ug_resume");
 
 	return 0;
 }
@@ -846,16 +1183,48 @@ int ugman_pause(void)
 
 	_DBG("ugman_pause called");
 
-	ecore_idler_add((Ecore_Task_Cb)ugman_ug_pause, ug_man.root);
+	/* going to background: release resources before anything else */
+	ug_sched_add(UG_SCHED_URGENT, (Ecore_Task_Cb)ugman_ug_pause,
+		     ug_man.root, "ug_pause");
 
 	return 0;
 }
 
 static int ugman_send_event_pre(void *data)
 {
+	enum ug_event events[UG_EVENT_MAX];
+	unsigned int seqs[UG_EVENT_MAX];
+	unsigned int mask = 0;
+	int count = 0;
+	int i;
+	int j;
+
+	ug_man.event_jobs &= ~(1U << (long)data);
+
+	/* the first job to run delivers every pending event, oldest first */
+	for (i = 0; i < UG_EVENT_MAX; i++) {
+		if (ug_man.pending_evt[i] == UG_EVENT_NONE)
+			continue;
+
+		for (j = count; j > 0 && (int)(seqs[j - 1] -
+					       ug_man.pending_seq[i]) > 0; j--) {
+			events[j] = events[j - 1];
+			seqs[j] = seqs[j - 1];
+		}
+		events[j] = ug_man.pending_evt[i];
+		seqs[j] = ug_man.pending_seq[i];
+		count++;
+
+		mask |= UG_EVENT_MASK(ug_man.pending_evt[i]);
+		ug_man.pending_evt[i] = UG_EVENT_NONE;
+	}
+
+	if (!count)
+		return 0;
+
 	job_start();
 
-	ugman_ug_event(ug_man.root, (enum ug_event)data);
+	ugman_ug_events(ug_man.root, events, count, mask);
 
 	job_end();
 
@@ -865,6 +1234,8 @@ static int ugman_send_event_pre(void *data)
 int ugman_send_event(enum ug_event event)
 {
 	int is_rotation = 1;
+	enum ug_sched_prio prio;
+	int slot = event;
 
 	/* Propagate event */
 	if (!ug_man.is_initted) {
@@ -872,6 +1243,10 @@ int ugman_send_event(enum ug_event event)
 		return -1;
 	}
 
+	/* preloaded and idle modules are the cheapest memory to give back */
+	if (event == UG_EVENT_LOW_MEMORY)
+		ug_module_purge();
+
 	if (!ug_man.root) {
 		_WRN("ugman_send_event failed: no root");
 		return -1;
@@ -893,7 +1268,24 @@ int ugman_send_event(enum ug_event event)
 		is_rotation = 0;
 	}
 
-	ecore_idler_add((Ecore_Task_Cb)ugman_send_event_pre, (void *)event);
+	UG_METRICS_INC(events);
+
+	/* all rotations share a slot, only the latest one matters */
+	if (is_rotation)
+		slot = UG_EVENT_ROTATE_PORTRAIT;
+
+	if (ug_man.pending_evt[slot] != UG_EVENT_NONE)
+		_DBG("event(%d) replaces pending event(%d)", event,
+		     ug_man.pending_evt[slot]);
+	ug_man.pending_evt[slot] = event;
+	ug_man.pending_seq[slot] = ++ug_man.event_seq;
+
+	/* the rotation must be applied with the next frame */
+	prio = is_rotation ? UG_SCHED_URGENT : UG_SCHED_NORMAL;
+	if (!(ug_man.event_jobs & (1U << prio))
+	    && ug_sched_add(prio, (Ecore_Task_Cb)ugman_send_event_pre,
+			    (void *)(long)prio, "send_event"))
+		ug_man.event_jobs |= 1U << prio;
 
 	if (is_rotation && ug_man.fv_top)
 		ugman_indicator_update(ug_man.fv_top->opt, event);
@@ -916,7 +1308,9 @@ static int ugman_send_key_event_to_ug(ui_gadget_h ug,
 	}
 
 	if (ops && ops->key_event) {
+		ug_op_enter(ug, UG_OP_KEY_EVENT);
 		ops->key_event(ug, event, ug->service, ops->priv);
+		ug_op_leave(ug, UG_OP_KEY_EVENT);
 	} else {
 		return -1;
 	}
@@ -937,6 +1331,7 @@ int ugman_send_key_event(enum ug_key_event event)
 		return -1;
 	}
 
+	UG_METRICS_INC(key_events);
 	return ugman_send_key_event_to_ug(ug_man.fv_top, event);
 }
 
@@ -955,11 +1350,17 @@ int ugman_send_message(ui_gadget_h ug, service_h msg)
 		return -1;
 	}
 
+	UG_PROBE(message, ug);
+	ug_metrics_message(msg, 0);
+
 	if (ug->module)
 		ops = &ug->module->ops;
 
-	if (ops && ops->message)
+	if (ops && ops->message) {
+		ug_op_enter(ug, UG_OP_MESSAGE);
 		ops->message(ug, msg, ug->service, ops->priv);
+		ug_op_leave(ug, UG_OP_MESSAGE);
+	}
 
 	return 0;
 }
@@ -996,5 +1397,8 @@ static inline void job_end(void)
 
 int ugman_ug_exist(ui_gadget_h ug)
 {
-	return ugman_ug_find(ug_man.root, ug);
+	if (!ug || !ug_man.live)
+		return 0;
+
+	return g_hash_table_lookup(ug_man.live, ug) ? 1 : 0;
 }
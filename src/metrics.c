@@ -0,0 +1,250 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "ug.h"
+#include "ug-metrics.h"
+#include "ug-dbg.h"
+
+/* counts until ug_metrics_init() moves them into shared memory */
+static struct ug_metrics ug_metrics_local;
+
+UG_INTERNAL_API struct ug_metrics *ug_metrics = &ug_metrics_local;
+
+static char ug_metrics_shm[64];
+
+/* UG_IDLER_LAG_MS in ns, 0: no alert */
+static uint64_t ug_metrics_lag_alert;
+
+/* nodes[] slots given back, and the first slot never handed out */
+static uint16_t ug_metrics_free[UG_METRICS_NODES];
+static int ug_metrics_n_free;
+static int ug_metrics_next;
+
+static void ug_metrics_fini(void)
+{
+	shm_unlink(ug_metrics_shm);
+}
+
+int ug_metrics_init(void)
+{
+	struct ug_metrics *m;
+	const char *env;
+	int fd;
+
+	if (ug_metrics != &ug_metrics_local)
+		return 0;
+
+	env = getenv("UG_IDLER_LAG_MS");
+	if (env && strtod(env, NULL) > 0)
+		ug_metrics_lag_alert = strtod(env, NULL) * 1000000.0;
+
+	/* a crash leaves the segment behind, so only on request */
+	env = getenv("UG_METRICS");
+	if (!env || !*env || !strcmp(env, "0"))
+		return 0;
+
+	snprintf(ug_metrics_shm, sizeof(ug_metrics_shm), UG_METRICS_SHM,
+		 getpid());
+
+	/* a segment left behind by a crashed process with our pid is reset */
+	fd = shm_open(ug_metrics_shm, O_CREAT | O_TRUNC | O_RDWR, 0600);
+	if (fd < 0) {
+		_WRN("ug metrics: shm_open(%s) failed: %s", ug_metrics_shm,
+		     strerror(errno));
+		return -1;
+	}
+
+	if (ftruncate(fd, sizeof(struct ug_metrics)) < 0) {
+		_WRN("ug metrics: ftruncate(%s) failed: %s", ug_metrics_shm,
+		     strerror(errno));
+		goto err;
+	}
+
+	m = mmap(NULL, sizeof(struct ug_metrics), PROT_READ | PROT_WRITE,
+		 MAP_SHARED, fd, 0);
+	if (m == MAP_FAILED) {
+		_WRN("ug metrics: mmap(%s) failed: %s", ug_metrics_shm,
+		     strerror(errno));
+		goto err;
+	}
+	close(fd);
+
+	memcpy(m, &ug_metrics_local, sizeof(struct ug_metrics));
+	m->magic = UG_METRICS_MAGIC;
+	m->version = UG_METRICS_VERSION;
+	m->size = sizeof(struct ug_metrics);
+	m->pid = getpid();
+	__atomic_store_n(&ug_metrics, m, __ATOMIC_RELEASE);
+
+	atexit(ug_metrics_fini);
+
+	_DBG("ug metrics: published in %s", ug_metrics_shm);
+	return 0;
+
+ err:
+	close(fd);
+	shm_unlink(ug_metrics_shm);
+	return -1;
+}
+
+void ug_metrics_node_add(ui_gadget_h ug)
+{
+	struct ug_metrics_node *n;
+	int i;
+
+	UG_METRICS_INC(alive[ug->state]);
+
+	/* the tree is only changed from the main loop */
+	if (ug_metrics_n_free) {
+		i = ug_metrics_free[--ug_metrics_n_free];
+	} else if (ug_metrics_next < UG_METRICS_NODES) {
+		i = ug_metrics_next++;
+	} else {
+		UG_METRICS_INC(nodes_dropped);
+		return;
+	}
+	n = &ug_metrics->nodes[i];
+
+	n->parent = 0;
+	snprintf(n->name, sizeof(n->name), "%s", ug->name ? ug->name : "");
+	n->state = ug->state;
+	n->layout = ug->layout_state;
+	n->mode = ug->mode;
+	/* published last, readers check it before and after copying */
+	__atomic_store_n(&n->ug, (uintptr_t)ug, __ATOMIC_RELEASE);
+
+	ug->metrics_node = i + 1;
+}
+
+void ug_metrics_node_parent(ui_gadget_h ug)
+{
+	struct ug_metrics_node *n;
+
+	if (!ug->metrics_node)
+		return;
+
+	n = &ug_metrics->nodes[ug->metrics_node - 1];
+	__atomic_store_n(&n->parent, (uintptr_t)ug->parent, __ATOMIC_RELAXED);
+	n->mode = ug->mode;
+}
+
+void ug_metrics_node_del(ui_gadget_h ug)
+{
+	UG_METRICS_DEC(alive[ug->state]);
+
+	if (!ug->metrics_node)
+		return;
+
+	__atomic_store_n(&ug_metrics->nodes[ug->metrics_node - 1].ug, 0,
+			 __ATOMIC_RELEASE);
+	ug_metrics_free[ug_metrics_n_free++] = ug->metrics_node - 1;
+	ug->metrics_node = 0;
+}
+
+static void ug_metrics_bundle_cb(const char *key, const char *val,
+				 void *data)
+{
+	uint64_t *bytes = data;
+
+	*bytes += strlen(key) + 1;
+	if (val)
+		*bytes += strlen(val) + 1;
+}
+
+void ug_metrics_message(service_h msg, int result)
+{
+	bundle *b = NULL;
+	uint64_t bytes = 0;
+
+	if (msg && !service_to_bundle(msg, &b) && b)
+		bundle_foreach(b, ug_metrics_bundle_cb, &bytes);
+
+	if (result) {
+		UG_METRICS_INC(results);
+		UG_METRICS_ADD(result_bytes, bytes);
+	} else {
+		UG_METRICS_INC(messages);
+		UG_METRICS_ADD(message_bytes, bytes);
+	}
+}
+
+/* job types are string literals; returns slot + 1, 0 when all are taken */
+int ug_metrics_job(const char *name)
+{
+	struct ug_metrics_job *j;
+	int i;
+
+	/* jobs are only queued from the main loop */
+	for (i = 0; i < UG_METRICS_JOBS; i++) {
+		j = &ug_metrics->jobs[i];
+		if (!j->name[0]) {
+			snprintf(j->name, sizeof(j->name), "%s", name);
+			break;
+		}
+		if (!strncmp(j->name, name, sizeof(j->name) - 1))
+			break;
+	}
+
+	if (i == UG_METRICS_JOBS)
+		return 0;
+
+	UG_METRICS_INC(jobs[i].queued);
+	return i + 1;
+}
+
+void ug_metrics_job_run(int job, uint64_t lag_ns)
+{
+	struct ug_metrics_job *j;
+
+	if (!job)
+		return;
+
+	j = &ug_metrics->jobs[job - 1];
+	UG_METRICS_INC(jobs[job - 1].runs);
+	UG_METRICS_ADD(jobs[job - 1].lag_sum, lag_ns);
+	UG_METRICS_INC(jobs[job - 1].lag_hist[ug_metrics_lag_bucket(lag_ns)]);
+	if (lag_ns > j->lag_max)
+		__atomic_store_n(&j->lag_max, lag_ns, __ATOMIC_RELAXED);
+
+	if (ug_metrics_lag_alert && lag_ns > ug_metrics_lag_alert) {
+		UG_METRICS_INC(jobs[job - 1].late);
+		_WRN("job %s ran %llu us after it was queued, %lld of its "
+		     "kind still queued", j->name,
+		     (unsigned long long)lag_ns / 1000,
+		     (long long)j->queued - 1);
+	}
+}
+
+void ug_metrics_job_done(int job)
+{
+	if (job)
+		UG_METRICS_DEC(jobs[job - 1].queued);
+}
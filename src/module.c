@@ -19,6 +19,7 @@
  *
  */
 
+#define _GNU_SOURCE
 #include <linux/limits.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,110 +27,496 @@
 #include <errno.h>
 #include <dlfcn.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 
+#include <glib.h>
+#include <Ecore.h>
 #include <app_manager.h>
 
 #include "ug-module.h"
+#include "ug-index.h"
+#include "ug-metrics.h"
+#include "ug-sched.h"
 #include "ug-dbg.h"
 
 #define UG_MODULE_INIT_SYM "UG_MODULE_INIT"
 #define UG_MODULE_EXIT_SYM "UG_MODULE_EXIT"
 
-static int file_exist(const char *filename)
+/* seconds an unused module stays resident, see UG_MODULE_GRACE */
+#define UG_MODULE_GRACE_DEFAULT 10.0
+
+static const char *ug_pkg_roots[] = UG_INDEX_PKG_ROOTS;
+static const char *ug_lib_dirs[] = UG_INDEX_LIB_DIRS;
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+struct ug_path_cache {
+	int is_initted:1;
+	char *pkg_name;
+	/* UG_MODULE_PATH of bench builds: searched first, and bypasses the
+	 * index; always NULL in the library */
+	char **user_dirs;
+	/* name -> resolved path; misses are not kept, so that a gadget
+	 * installed while the app runs is found */
+	GHashTable *table;
+};
+
+static struct ug_path_cache path_cache;
+
+/* async loading resolves paths from worker threads */
+G_LOCK_DEFINE_STATIC(path_cache);
+
+/* a dlopen()ed gadget library shared by all instances of the gadget */
+struct ug_module_entry {
+	char *name;
+	void *handle;
+	int (*init) (struct ug_module_ops *ops);
+	void (*exit) (struct ug_module_ops *ops);
+	int ref;
+	double idle_since;
+	/* preloaded and not used yet */
+	int pinned:1;
+	/* ops initialized ahead of time by ug_preload() */
+	struct ug_module_ops *warm_ops;
+};
+
+struct ug_preload_req {
+	char *name;
+	int flags;
+};
+
+struct ug_module_registry {
+	/* name -> struct ug_module_entry */
+	GHashTable *table;
+	double grace;
+	Ecore_Timer *sweep_timer;
+	struct ug_sched_job *sweep_job;
+	GSList *preload_list;
+	struct ug_sched_job *preload_job;
+	/* UG_MODULE_TIMING: log the load times of each module */
+	int timing_log:1;
+};
+
+static struct ug_module_registry registry;
+
+static void ug_module_entry_close(gpointer data)
 {
-	FILE *file;
-	if ((file = fopen(filename, "r"))) {
-		fclose(file);
-		return 1;
+	struct ug_module_entry *entry = data;
+
+	_DBG("module(%s) dlclose", entry->name);
+
+	if (entry->warm_ops) {
+		if (entry->exit)
+			entry->exit(entry->warm_ops);
+		free(entry->warm_ops);
 	}
 
+	dlclose(entry->handle);
+	free(entry->name);
+	free(entry);
+}
+
+int ug_module_init(void)
+{
+	const char *env;
+
+	if (path_cache.is_initted)
+		return 0;
+
+	path_cache.table = g_hash_table_new_full(g_str_hash, g_str_equal,
+						 free, free);
+	if (!path_cache.table) {
+		_ERR("path cache create failed");
+		return -1;
+	}
+
+	registry.table = g_hash_table_new_full(g_str_hash, g_str_equal,
+					       NULL, ug_module_entry_close);
+	if (!registry.table) {
+		_ERR("module registry create failed");
+		g_hash_table_destroy(path_cache.table);
+		path_cache.table = NULL;
+		return -1;
+	}
+
+	registry.grace = UG_MODULE_GRACE_DEFAULT;
+	env = getenv("UG_MODULE_GRACE");
+	if (env)
+		registry.grace = strtod(env, NULL);
+
+	env = getenv("UG_MODULE_TIMING");
+	if (env && *env && strcmp(env, "0"))
+		registry.timing_log = 1;
+
+	/* the environment must not pick what the library dlopen()s */
+#ifdef UG_BENCH
+	env = getenv("UG_MODULE_PATH");
+	if (env && *env)
+		path_cache.user_dirs = g_strsplit(env, ":", -1);
+#endif
+
+	app_manager_get_package(getpid(), &path_cache.pkg_name);
+	if (!path_cache.user_dirs)
+		ug_index_open(UG_INDEX_FILE, path_cache.pkg_name);
+	path_cache.is_initted = 1;
+
 	return 0;
 }
 
-struct ug_module *ug_module_load(const char *name)
+static unsigned long long ug_module_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void ug_load_phase_begin(struct ug_load_times *t,
+				enum ug_load_phase phase)
+{
+	if (t)
+		t->phases[phase].begin = ug_module_now();
+}
+
+static void ug_load_phase_end(struct ug_load_times *t,
+			      enum ug_load_phase phase)
+{
+	if (t)
+		t->phases[phase].end = ug_module_now();
+}
+
+static unsigned long long ug_load_phase_us(struct ug_load_times *t,
+					   enum ug_load_phase phase)
+{
+	return (t->phases[phase].end - t->phases[phase].begin) / 1000;
+}
+
+/* one key=value line per load, so that it is easy to grep and parse */
+static void ug_module_timing_log(const char *name, struct ug_load_times *t)
+{
+	UG_LOG(UG_LOG_LEVEL_INFO, LOGI,
+	       "ug_load name=%s cached=%d warm=%d package_us=%llu "
+	       "path_us=%llu dlopen_us=%llu symbol_us=%llu init_us=%llu "
+	       "total_us=%llu", name, t->cached, t->warm,
+	       ug_load_phase_us(t, UG_LOAD_PHASE_PACKAGE),
+	       ug_load_phase_us(t, UG_LOAD_PHASE_PATH),
+	       ug_load_phase_us(t, UG_LOAD_PHASE_DLOPEN),
+	       ug_load_phase_us(t, UG_LOAD_PHASE_SYMBOL),
+	       ug_load_phase_us(t, UG_LOAD_PHASE_INIT),
+	       (t->end - t->begin) / 1000);
+}
+
+static char *ug_module_path_probe(const char *name)
 {
-	void *handle;
-	struct ug_module *module;
 	char ug_file[PATH_MAX];
-	char *pkg_name = NULL;
+	unsigned int i;
 
-	int (*module_init) (struct ug_module_ops *ops);
+	for (i = 0; path_cache.user_dirs && path_cache.user_dirs[i]; i++) {
+		if (!*path_cache.user_dirs[i])
+			continue;
+		snprintf(ug_file, PATH_MAX, "%s/"
+			 UG_INDEX_LIB_PREFIX "%s" UG_INDEX_LIB_SUFFIX,
+			 path_cache.user_dirs[i], name);
+		if (!access(ug_file, R_OK))
+			return strdup(ug_file);
+	}
 
-	module = calloc(1, sizeof(struct ug_module));
-	if (!module) {
-		errno = ENOMEM;
+	if (path_cache.pkg_name) {
+		for (i = 0; i < ARRAY_SIZE(ug_pkg_roots); i++) {
+			snprintf(ug_file, PATH_MAX, "%s/%s/lib/"
+				 UG_INDEX_LIB_PREFIX "%s" UG_INDEX_LIB_SUFFIX,
+				 ug_pkg_roots[i], path_cache.pkg_name, name);
+			if (!access(ug_file, R_OK))
+				return strdup(ug_file);
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(ug_lib_dirs); i++) {
+		snprintf(ug_file, PATH_MAX, "%s/"
+			 UG_INDEX_LIB_PREFIX "%s" UG_INDEX_LIB_SUFFIX,
+			 ug_lib_dirs[i], name);
+		if (!access(ug_file, R_OK))
+			return strdup(ug_file);
+	}
+
+	return NULL;
+}
+
+static const char *ug_module_path_get(const char *name)
+{
+	gpointer path = NULL;
+	const char *indexed;
+	char *key;
+	int r;
+
+	if (!path_cache.is_initted && ug_module_init())
 		return NULL;
+
+	G_LOCK(path_cache);
+
+	path = g_hash_table_lookup(path_cache.table, name);
+	if (path)
+		goto out;
+
+	/*
+	 * The index answers for what it holds; a miss may be a gadget
+	 * installed after the index was checked at ug_init(), and a
+	 * changed entry is out of date: both are probed.
+	 */
+	r = ug_index_lookup(name, &indexed);
+	if (r > 0)
+		path = strdup(indexed);
+	else
+		path = ug_module_path_probe(name);
+	if (!path)
+		goto out;
+
+	key = strdup(name);
+	if (!key) {
+		free(path);
+		path = NULL;
+		goto out;
 	}
+	g_hash_table_insert(path_cache.table, key, path);
+
+ out:
+	G_UNLOCK(path_cache);
+
+	/* entries are never removed, so the path outlives the lock */
+	return path;
+}
+
+static void ug_module_sweep_schedule(double delay);
 
-	app_manager_get_package(getpid(), &pkg_name);
+static Eina_Bool ug_module_sweep(void *data)
+{
+	struct ug_module_entry *entry;
+	GHashTableIter iter;
+	double now = ecore_time_get();
+	double next = -1.0;
+	double left;
+
+	registry.sweep_job = NULL;
+
+	g_hash_table_iter_init(&iter, registry.table);
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&entry)) {
+		if (entry->ref > 0 || entry->pinned)
+			continue;
 
-	do {
-		if (pkg_name) {
-			snprintf(ug_file, PATH_MAX, "/usr/apps/%s/lib/libug-%s.so", pkg_name, name);
-			if (file_exist(ug_file))
-				break;
-			snprintf(ug_file, PATH_MAX, "/opt/apps/%s/lib/libug-%s.so", pkg_name, name);
-			if (file_exist(ug_file))
-				break;
+		left = entry->idle_since + registry.grace - now;
+		if (left <= 0.0) {
+			g_hash_table_iter_remove(&iter);
+			UG_METRICS_DEC(modules_resident);
+		} else if (next < 0.0 || left < next) {
+			next = left;
 		}
-		snprintf(ug_file, PATH_MAX, "/usr/ug/lib/libug-%s.so", name);
-		if (file_exist(ug_file))
-			break;
-		snprintf(ug_file, PATH_MAX, "/opt/usr/ug/lib/libug-%s.so", name);
-		if (file_exist(ug_file))
-			break;
-	} while (0);
+	}
 
-	if(pkg_name) {
-		free(pkg_name);
-		pkg_name = NULL;
+	if (next >= 0.0)
+		ug_module_sweep_schedule(next);
+
+	_DBG("module cache: hit(%llu) miss(%llu) resident(%lld)",
+	     (unsigned long long)ug_metrics->module_hits,
+	     (unsigned long long)ug_metrics->module_misses,
+	     (long long)ug_metrics->modules_resident);
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool ug_module_sweep_timer_cb(void *data)
+{
+	registry.sweep_timer = NULL;
+
+	/* dlclose() runs destructors and unmaps; keep it off busy frames */
+	if (!registry.sweep_job)
+		registry.sweep_job = ug_sched_add(UG_SCHED_BACKGROUND,
+						  ug_module_sweep, NULL,
+						  "module_sweep");
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static void ug_module_sweep_schedule(double delay)
+{
+	if (registry.sweep_timer || registry.sweep_job)
+		return;
+
+	registry.sweep_timer = ecore_timer_add(delay, ug_module_sweep_timer_cb,
+					       NULL);
+}
+
+/* times is NULL when nobody is waiting for the module, e.g. preloading */
+static struct ug_module_entry *ug_module_entry_open(const char *name,
+						    struct ug_load_times *times)
+{
+	struct ug_module_entry *entry;
+	const char *ug_file;
+
+	ug_load_phase_begin(times, UG_LOAD_PHASE_PATH);
+	ug_file = ug_module_path_get(name);
+	ug_load_phase_end(times, UG_LOAD_PHASE_PATH);
+	if (!ug_file) {
+		_ERR("module(%s) is not installed", name);
+		errno = ENOENT;
+		return NULL;
+	}
+
+	entry = calloc(1, sizeof(struct ug_module_entry));
+	if (!entry) {
+		errno = ENOMEM;
+		return NULL;
 	}
 
-	handle = dlopen(ug_file, RTLD_LAZY);
-	if (!handle) {
+	ug_load_phase_begin(times, UG_LOAD_PHASE_DLOPEN);
+	entry->handle = dlopen(ug_file, RTLD_LAZY);
+	ug_load_phase_end(times, UG_LOAD_PHASE_DLOPEN);
+	if (!entry->handle) {
 		_ERR("dlopen failed: %s", dlerror());
-		goto module_free;
+		goto entry_free;
+	}
+
+	ug_load_phase_begin(times, UG_LOAD_PHASE_SYMBOL);
+	entry->init = dlsym(entry->handle, UG_MODULE_INIT_SYM);
+	if (!entry->init) {
+		_ERR("dlsym failed: %s", dlerror());
+		goto entry_dlclose;
 	}
 
-	module_init = dlsym(handle, UG_MODULE_INIT_SYM);
-	if (!module_init) {
+	entry->exit = dlsym(entry->handle, UG_MODULE_EXIT_SYM);
+	ug_load_phase_end(times, UG_LOAD_PHASE_SYMBOL);
+	if (!entry->exit)
 		_ERR("dlsym failed: %s", dlerror());
-		goto module_dlclose;
+
+	entry->name = strdup(name);
+	if (!entry->name)
+		goto entry_dlclose;
+
+	g_hash_table_insert(registry.table, entry->name, entry);
+	UG_METRICS_INC(modules_resident);
+
+	return entry;
+
+ entry_dlclose:
+	dlclose(entry->handle);
+
+ entry_free:
+	free(entry);
+	return NULL;
+}
+
+static void ug_module_entry_unref(struct ug_module_entry *entry)
+{
+	if (--entry->ref > 0)
+		return;
+
+	if (registry.grace <= 0.0) {
+		g_hash_table_remove(registry.table, entry->name);
+		UG_METRICS_DEC(modules_resident);
+		return;
 	}
 
-	if (module_init(&module->ops))
-		goto module_dlclose;
+	entry->idle_since = ecore_time_get();
+	ug_module_sweep_schedule(registry.grace);
+}
+
+struct ug_module *ug_module_load(const char *name)
+{
+	struct ug_module_entry *entry;
+	struct ug_module *module;
+	struct ug_load_times *t;
+	int r;
+
+	module = calloc(1, sizeof(struct ug_module));
+	if (!module) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	t = &module->times;
+	t->begin = ug_module_now();
+
+	if (!path_cache.is_initted) {
+		ug_load_phase_begin(t, UG_LOAD_PHASE_PACKAGE);
+		r = ug_module_init();
+		ug_load_phase_end(t, UG_LOAD_PHASE_PACKAGE);
+		if (r) {
+			free(module);
+			return NULL;
+		}
+	}
 
-	module->handle = handle;
 	module->module_name = strdup(name);
-	return module;
+	if (!module->module_name) {
+		errno = ENOMEM;
+		goto module_free;
+	}
 
- module_dlclose:
-	dlclose(handle);
+	entry = g_hash_table_lookup(registry.table, name);
+	if (entry) {
+		UG_METRICS_INC(module_hits);
+		entry->pinned = 0;
+		t->cached = 1;
+	} else {
+		UG_METRICS_INC(module_misses);
+		entry = ug_module_entry_open(name, t);
+		if (!entry)
+			goto module_free;
+	}
+
+	entry->ref++;
+	_DBG("module(%s) ref(%d)", name, entry->ref);
+
+	/* every instance gets its own ops and private data */
+	if (entry->warm_ops) {
+		memcpy(&module->ops, entry->warm_ops,
+		       sizeof(struct ug_module_ops));
+		free(entry->warm_ops);
+		entry->warm_ops = NULL;
+		t->warm = 1;
+	} else {
+		ug_load_phase_begin(t, UG_LOAD_PHASE_INIT);
+		r = entry->init(&module->ops);
+		ug_load_phase_end(t, UG_LOAD_PHASE_INIT);
+		if (r) {
+			ug_module_entry_unref(entry);
+			goto module_free;
+		}
+	}
+
+	module->entry = entry;
+	module->handle = entry->handle;
+	t->end = ug_module_now();
+
+	if (registry.timing_log)
+		ug_module_timing_log(name, t);
+
+	return module;
 
  module_free:
+	free(module->module_name);
 	free(module);
 	return NULL;
 }
 
 int ug_module_unload(struct ug_module *module)
 {
-	void (*module_exit) (struct ug_module_ops *ops);
+	struct ug_module_entry *entry;
 
 	if (!module) {
 		errno = EINVAL;
 		return -1;
 	}
 
-	if (module->handle) {
-		module_exit = dlsym(module->handle, UG_MODULE_EXIT_SYM);
-		if (module_exit)
-			module_exit(&module->ops);
-		else
-			_ERR("dlsym failed: %s", dlerror());
+	entry = module->entry;
+	if (entry) {
+		if (entry->exit)
+			entry->exit(&module->ops);
 
-		dlclose(module->handle);
+		ug_module_entry_unref(entry);
+		module->entry = NULL;
 		module->handle = NULL;
 	}
 
@@ -140,28 +527,176 @@ int ug_module_unload(struct ug_module *module)
 	return 0;
 }
 
-int ug_exist(const char* name)
+static void ug_module_preload_one(const char *name, int flags)
 {
-	char ug_file[PATH_MAX] = {0,};
-	int ret = 0;
+	struct ug_module_entry *entry;
+	struct ug_module_ops *ops;
 
-	do {
-		snprintf(ug_file, PATH_MAX, "/usr/ug/lib/libug-%s.so", name);
-		if (file_exist(ug_file)) {
-			ret = 1;
-			break;
-		}
-		snprintf(ug_file, PATH_MAX, "/opt/ug/lib/libug-%s.so", name);
-		if (file_exist(ug_file)) {
-			ret = 1;
+	entry = g_hash_table_lookup(registry.table, name);
+	if (!entry) {
+		entry = ug_module_entry_open(name, NULL);
+		if (!entry)
+			return;
+		entry->pinned = 1;
+		entry->idle_since = ecore_time_get();
+	}
+
+	if (!(flags & UG_PRELOAD_INIT) || entry->warm_ops)
+		return;
+
+	ops = calloc(1, sizeof(struct ug_module_ops));
+	if (!ops)
+		return;
+
+	if (entry->init(ops)) {
+		_ERR("module(%s) preload init failed", name);
+		free(ops);
+		return;
+	}
+
+	entry->warm_ops = ops;
+}
+
+static Eina_Bool ug_module_preload_cb(void *data)
+{
+	struct ug_preload_req *req;
+
+	if (!registry.preload_list) {
+		registry.preload_job = NULL;
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	/* one module per background slot */
+	req = registry.preload_list->data;
+	registry.preload_list = g_slist_delete_link(registry.preload_list,
+						    registry.preload_list);
+
+	_DBG("module(%s) preload flags(%d)", req->name, req->flags);
+	ug_module_preload_one(req->name, req->flags);
+
+	free(req->name);
+	free(req);
+
+	if (!registry.preload_list) {
+		registry.preload_job = NULL;
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+int ug_module_preload(const char *names[], int count, int flags)
+{
+	struct ug_preload_req *req;
+	GSList *added = NULL;
+	int r = 0;
+	int i;
+
+	if (!path_cache.is_initted && ug_module_init())
+		return -1;
+
+	for (i = 0; i < count; i++) {
+		if (!names[i])
+			continue;
+
+		req = calloc(1, sizeof(struct ug_preload_req));
+		if (!req) {
+			r = -1;
 			break;
 		}
-		snprintf(ug_file, PATH_MAX, "/opt/usr/ug/lib/libug-%s.so", name);
-		if (file_exist(ug_file)) {
-			ret = 1;
+
+		req->name = strdup(names[i]);
+		if (!req->name) {
+			free(req);
+			r = -1;
 			break;
 		}
-	} while (0);
+		req->flags = flags;
+
+		added = g_slist_prepend(added, req);
+	}
+
+	/* what was queued before running out of memory is still preloaded */
+	registry.preload_list = g_slist_concat(registry.preload_list,
+					       g_slist_reverse(added));
+
+	if (registry.preload_list && !registry.preload_job)
+		registry.preload_job = ug_sched_add(UG_SCHED_BACKGROUND,
+						    ug_module_preload_cb,
+						    NULL, "module_preload");
+
+	if (r)
+		errno = ENOMEM;
+
+	return r;
+}
+
+static gboolean ug_module_entry_unused(gpointer key, gpointer value,
+				       gpointer data)
+{
+	struct ug_module_entry *entry = value;
 
-	return ret;
+	if (entry->ref > 0)
+		return FALSE;
+
+	UG_METRICS_DEC(modules_resident);
+	return TRUE;
+}
+
+/*
+ * UG_EVENT_LOW_MEMORY: cancel the pending preloads and unload every
+ * module no gadget uses, preloaded or within its grace period alike
+ */
+void ug_module_purge(void)
+{
+	struct ug_preload_req *req;
+	guint n;
+
+	if (!path_cache.is_initted)
+		return;
+
+	while (registry.preload_list) {
+		req = registry.preload_list->data;
+		registry.preload_list =
+			g_slist_delete_link(registry.preload_list,
+					    registry.preload_list);
+		free(req->name);
+		free(req);
+	}
+
+	n = g_hash_table_foreach_remove(registry.table,
+					ug_module_entry_unused, NULL);
+	_DBG("module cache: %u unused modules dropped", n);
+}
+
+void *ug_module_prefetch(const char *name)
+{
+	const char *ug_file;
+	struct stat st;
+	int fd;
+
+	ug_file = ug_module_path_get(name);
+	if (!ug_file)
+		return NULL;
+
+	/* pull the whole file in one go instead of faulting it page by page */
+	fd = open(ug_file, O_RDONLY | O_CLOEXEC);
+	if (fd >= 0) {
+		if (!fstat(fd, &st) && st.st_size > 0)
+			readahead(fd, 0, st.st_size);
+		close(fd);
+	}
+
+	return dlopen(ug_file, RTLD_LAZY);
+}
+
+void ug_module_prefetch_release(void *handle)
+{
+	if (handle)
+		dlclose(handle);
+}
+
+int ug_exist(const char* name)
+{
+	return ug_module_path_get(name) ? 1 : 0;
 }
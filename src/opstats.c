@@ -0,0 +1,380 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <execinfo.h>
+#include <sys/syscall.h>
+
+#include <glib.h>
+
+#include "ug.h"
+#include "ug-op.h"
+#include "ug-opstats.h"
+#include "ug-dbg.h"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+#define UG_OP_BACKTRACE_MAX 64
+
+struct ug_opstats_module {
+	char *name;
+	struct ug_module_op_stats stats;
+};
+
+struct ug_opstats_frame {
+	struct ug_module_op_stats *stats;
+	const char *name;
+	int op;
+	unsigned long long wall;
+	/* 0: CPU time is not measured */
+	unsigned long long cpu;
+};
+
+struct ug_opstats {
+	/* name -> struct ug_opstats_module */
+	GHashTable *table;
+
+	/* operations in progress, outermost first */
+	struct ug_opstats_frame stack[UG_OP_DEPTH_MAX];
+	int depth;
+
+	unsigned long long budget;
+	int backtrace;
+	timer_t timer;
+	int has_timer;
+
+	/* the operation the watchdog fires in, for the signal handler */
+	const char *volatile wd_name;
+	volatile int wd_op;
+};
+
+static struct ug_opstats opstats;
+
+static unsigned long long ug_opstats_clock(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* 1 us buckets up to 8 us, then 4 per power of two */
+int ug_opstats_bucket(unsigned long long ns)
+{
+	unsigned long long us = ns / 1000;
+	int msb;
+	int b;
+
+	if (us < 8)
+		return us;
+
+	msb = 63 - __builtin_clzll(us);
+	b = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+
+	return b < UG_OP_HIST_BUCKETS ? b : UG_OP_HIST_BUCKETS - 1;
+}
+
+unsigned long long ug_opstats_bucket_ns(int bucket)
+{
+	int msb;
+
+	if (bucket < 8)
+		return bucket * 1000ULL;
+
+	msb = bucket / 4 + 1;
+	return ((4ULL + bucket % 4) << (msb - 2)) * 1000ULL;
+}
+
+static void ug_opstats_module_free(gpointer data)
+{
+	struct ug_opstats_module *m = data;
+
+	free(m->name);
+	free(m);
+}
+
+/* modules are never removed, so gadgets keep a pointer */
+static struct ug_opstats_module *ug_opstats_lookup(ui_gadget_h ug)
+{
+	struct ug_opstats_module *m;
+
+	if (ug->opstats)
+		return ug->opstats;
+
+	if (!ug->name)
+		return NULL;
+
+	if (!opstats.table) {
+		opstats.table = g_hash_table_new_full(g_str_hash, g_str_equal,
+						      NULL,
+						      ug_opstats_module_free);
+		if (!opstats.table)
+			return NULL;
+	}
+
+	m = g_hash_table_lookup(opstats.table, ug->name);
+	if (!m) {
+		m = calloc(1, sizeof(struct ug_opstats_module));
+		if (!m)
+			return NULL;
+		m->name = strdup(ug->name);
+		if (!m->name) {
+			free(m);
+			return NULL;
+		}
+		g_hash_table_insert(opstats.table, m->name, m);
+	}
+
+	ug->opstats = m;
+	return m;
+}
+
+/*
+ * async-signal-safe: write, and backtrace and backtrace_symbols_fd after
+ * the warm-up in budget_set
+ */
+static void ug_opstats_write(const char *s)
+{
+	ssize_t r;
+
+	r = write(STDERR_FILENO, s, strlen(s));
+	(void)r;
+}
+
+static void ug_opstats_watchdog_handler(int signo)
+{
+	void *frames[UG_OP_BACKTRACE_MAX];
+	const char *name = opstats.wd_name;
+	int n;
+
+	ug_opstats_write("ug watchdog: ");
+	ug_opstats_write(name ? name : "?");
+	ug_opstats_write(" ");
+	ug_opstats_write(ug_op_name(opstats.wd_op));
+	ug_opstats_write(" is over budget, backtrace:\n");
+
+	n = backtrace(frames, UG_OP_BACKTRACE_MAX);
+	backtrace_symbols_fd(frames, n, STDERR_FILENO);
+}
+
+static void ug_opstats_watchdog_arm(struct ug_opstats_frame *f)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	if (f) {
+		opstats.wd_name = f->name;
+		opstats.wd_op = f->op;
+		its.it_value.tv_sec = opstats.budget / 1000000000ULL;
+		its.it_value.tv_nsec = opstats.budget % 1000000000ULL;
+	}
+
+	timer_settime(opstats.timer, 0, &its, NULL);
+}
+
+void ug_opstats_enter(ui_gadget_h ug, int op)
+{
+	struct ug_opstats_frame *f;
+	struct ug_opstats_module *m;
+
+	if (opstats.depth++ >= UG_OP_DEPTH_MAX)
+		return;
+
+	/* the gadget may be gone when the operation returns */
+	f = &opstats.stack[opstats.depth - 1];
+	m = ug_opstats_lookup(ug);
+	f->stats = m ? &m->stats : NULL;
+	f->name = m ? m->name : NULL;
+	f->op = op;
+
+	/* nested operations run on the budget of the outermost one */
+	if (opstats.depth == 1 && opstats.backtrace)
+		ug_opstats_watchdog_arm(f);
+
+	/* a system call on kernels without a vDSO for it: budget only */
+	f->cpu = opstats.budget ?
+		ug_opstats_clock(CLOCK_THREAD_CPUTIME_ID) : 0;
+	f->wall = ug_opstats_clock(CLOCK_MONOTONIC);
+}
+
+void ug_opstats_leave(ui_gadget_h ug, int op)
+{
+	unsigned long long wall = ug_opstats_clock(CLOCK_MONOTONIC);
+	unsigned long long cpu = 0;
+	struct ug_opstats_frame *f;
+	struct ug_op_timing *t;
+
+	if (opstats.depth == 0)
+		return;
+
+	if (--opstats.depth >= UG_OP_DEPTH_MAX)
+		return;
+
+	f = &opstats.stack[opstats.depth];
+	if (opstats.depth == 0 && opstats.backtrace)
+		ug_opstats_watchdog_arm(NULL);
+
+	if (!f->stats || f->op != op)
+		return;
+
+	wall -= f->wall;
+
+	t = &f->stats->ops[op];
+	t->count++;
+	t->wall_sum += wall;
+	if (wall > t->wall_max)
+		t->wall_max = wall;
+	t->wall_hist[ug_opstats_bucket(wall)]++;
+
+	if (f->cpu) {
+		cpu = ug_opstats_clock(CLOCK_THREAD_CPUTIME_ID) - f->cpu;
+		t->cpu_sum += cpu;
+		if (cpu > t->cpu_max)
+			t->cpu_max = cpu;
+		t->cpu_hist[ug_opstats_bucket(cpu)]++;
+	}
+
+	if (opstats.budget && wall > opstats.budget) {
+		t->overruns++;
+		_WRN("ug(%s) %s took %llu us (cpu %llu us), over the budget of "
+		     "%llu us", f->name, ug_op_name(op), wall / 1000,
+		     cpu / 1000, opstats.budget / 1000);
+	}
+}
+
+int ug_opstats_budget_set(unsigned long long budget_ns, int with_backtrace)
+{
+	struct sigaction sa;
+	struct sigevent sev;
+	void *frame;
+	int fd;
+
+	if (opstats.backtrace)
+		ug_opstats_watchdog_arm(NULL);
+
+	opstats.budget = budget_ns;
+	opstats.backtrace = 0;
+
+	if (!budget_ns || !with_backtrace)
+		return 0;
+
+	if (!opstats.has_timer) {
+		/*
+		 * loads the unwinder, binds backtrace_symbols_fd and lets
+		 * dladdr() set up its tables now, not in the signal handler
+		 */
+		backtrace(&frame, 1);
+		fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+		if (fd >= 0) {
+			backtrace_symbols_fd(&frame, 1, fd);
+			close(fd);
+		}
+
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_handler = ug_opstats_watchdog_handler;
+		sa.sa_flags = SA_RESTART | SA_ONSTACK;
+		sigemptyset(&sa.sa_mask);
+		if (sigaction(UG_OP_WATCHDOG_SIGNAL, &sa, NULL)) {
+			_ERR("ug op watchdog: sigaction failed: %s",
+			     strerror(errno));
+			return -1;
+		}
+
+		/* operations run on this thread, the signal goes to it */
+		memset(&sev, 0, sizeof(sev));
+		sev.sigev_notify = SIGEV_THREAD_ID;
+		sev.sigev_signo = UG_OP_WATCHDOG_SIGNAL;
+		sev.sigev_notify_thread_id = syscall(SYS_gettid);
+		if (timer_create(CLOCK_MONOTONIC, &sev, &opstats.timer)) {
+			_ERR("ug op watchdog: timer_create failed: %s",
+			     strerror(errno));
+			return -1;
+		}
+		opstats.has_timer = 1;
+	}
+
+	opstats.backtrace = 1;
+	return 0;
+}
+
+int ug_opstats_init(void)
+{
+	const char *env;
+	double ms;
+
+	env = getenv("UG_OP_BUDGET_MS");
+	if (!env || !*env)
+		return 0;
+
+	ms = strtod(env, NULL);
+	if (ms <= 0)
+		return 0;
+
+	env = getenv("UG_OP_BACKTRACE");
+
+	return ug_opstats_budget_set(ms * 1000000.0,
+				     env && *env && strcmp(env, "0"));
+}
+
+int ug_opstats_module_get(const char *name, struct ug_module_op_stats *stats)
+{
+	struct ug_opstats_module *m = NULL;
+
+	if (opstats.table)
+		m = g_hash_table_lookup(opstats.table, name);
+	if (!m) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	memcpy(stats, &m->stats, sizeof(struct ug_module_op_stats));
+	return 0;
+}
+
+int ug_opstats_foreach(int (*func) (const char *name,
+				    const struct ug_module_op_stats *stats,
+				    void *data), void *data)
+{
+	struct ug_opstats_module *m;
+	GHashTableIter iter;
+	gpointer value;
+
+	if (!opstats.table)
+		return 0;
+
+	g_hash_table_iter_init(&iter, opstats.table);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		m = value;
+		if (func(m->name, &m->stats, data))
+			break;
+	}
+
+	return 0;
+}
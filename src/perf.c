@@ -0,0 +1,325 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <glib.h>
+#include <Ecore.h>
+
+#include "ug.h"
+#include "ug-op.h"
+#include "ug-perf.h"
+#include "ug-dbg.h"
+
+#define UG_PERF_FILE_FMT "/tmp/ug-perf-%d.txt"
+
+struct ug_perf_module {
+	char *name;
+	unsigned long long calls[UG_OP_MAX];
+	unsigned long long sums[UG_OP_MAX][UG_PERF_MAX];
+};
+
+struct ug_perf_frame {
+	struct ug_perf_module *m;
+	int op;
+	unsigned long long values[UG_PERF_MAX];
+};
+
+struct ug_perf {
+	/* counters that could be opened, in group read order */
+	int fds[UG_PERF_MAX];
+	int counters[UG_PERF_MAX];
+	int n;
+
+	/* name -> struct ug_perf_module */
+	GHashTable *table;
+
+	struct ug_perf_frame stack[UG_OP_DEPTH_MAX];
+	int depth;
+
+	char *path;
+	FILE *fp;
+	Ecore_Event_Handler *signal_handler;
+};
+
+static struct ug_perf perf;
+
+int ug_perf_enabled;
+
+static const struct {
+	const char *name;
+	__u32 type;
+	__u64 config;
+} ug_perf_events[UG_PERF_MAX] = {
+	{ "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ "cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	{ "minor_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN },
+	{ "major_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ },
+};
+
+static int ug_perf_open(int counter, int group)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = ug_perf_events[counter].type;
+	attr.config = ug_perf_events[counter].config;
+	attr.read_format = PERF_FORMAT_GROUP;
+	/* user space only, allowed with the default perf_event_paranoid */
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	/* this thread on any cpu; operations only run on the main thread */
+	return syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/* one read for the whole group */
+static int ug_perf_read(unsigned long long *values)
+{
+	__u64 buf[1 + UG_PERF_MAX];
+	int i;
+
+	if (read(perf.fds[0], buf, sizeof(buf)) <
+	    (ssize_t)((1 + perf.n) * sizeof(__u64)))
+		return -1;
+
+	for (i = 0; i < perf.n; i++)
+		values[perf.counters[i]] = buf[1 + i];
+
+	return 0;
+}
+
+static struct ug_perf_module *ug_perf_lookup(ui_gadget_h ug)
+{
+	struct ug_perf_module *m;
+
+	if (!ug->name)
+		return NULL;
+
+	m = g_hash_table_lookup(perf.table, ug->name);
+	if (m)
+		return m;
+
+	m = calloc(1, sizeof(struct ug_perf_module));
+	if (!m)
+		return NULL;
+	m->name = strdup(ug->name);
+	if (!m->name) {
+		free(m);
+		return NULL;
+	}
+	g_hash_table_insert(perf.table, m->name, m);
+
+	return m;
+}
+
+void ug_perf_enter(ui_gadget_h ug, int op)
+{
+	struct ug_perf_frame *f;
+
+	if (perf.depth++ >= UG_OP_DEPTH_MAX)
+		return;
+
+	f = &perf.stack[perf.depth - 1];
+	f->m = ug_perf_lookup(ug);
+	f->op = op;
+	if (f->m && ug_perf_read(f->values))
+		f->m = NULL;
+}
+
+void ug_perf_leave(ui_gadget_h ug, int op)
+{
+	unsigned long long values[UG_PERF_MAX];
+	struct ug_perf_frame *f;
+	int i;
+
+	if (perf.depth == 0)
+		return;
+
+	if (--perf.depth >= UG_OP_DEPTH_MAX)
+		return;
+
+	f = &perf.stack[perf.depth];
+	if (!f->m || f->op != op || ug_perf_read(values))
+		return;
+
+	f->m->calls[op]++;
+	for (i = 0; i < perf.n; i++)
+		f->m->sums[op][perf.counters[i]] +=
+		    values[perf.counters[i]] - f->values[perf.counters[i]];
+}
+
+static void ug_perf_module_write(FILE *fp, struct ug_perf_module *m)
+{
+	unsigned long long *s;
+	int has[UG_PERF_MAX] = { 0, };
+	int op;
+	int i;
+
+	for (i = 0; i < perf.n; i++)
+		has[perf.counters[i]] = 1;
+
+	for (op = 0; op < UG_OP_MAX; op++) {
+		if (!m->calls[op])
+			continue;
+
+		s = m->sums[op];
+		fprintf(fp, "%-32s %-10s %8llu", m->name,
+			ug_op_name(op), m->calls[op]);
+		for (i = 0; i < UG_PERF_MAX; i++) {
+			if (has[i])
+				fprintf(fp, " %14.1f",
+					(double)s[i] / m->calls[op]);
+			else
+				fprintf(fp, " %14s", "-");
+		}
+		if (has[UG_PERF_INSTRUCTIONS] && has[UG_PERF_CYCLES] &&
+		    s[UG_PERF_CYCLES])
+			fprintf(fp, " %6.2f\n", (double)s[UG_PERF_INSTRUCTIONS]
+				/ s[UG_PERF_CYCLES]);
+		else
+			fprintf(fp, " %6s\n", "-");
+	}
+}
+
+void ug_perf_dump(void)
+{
+	GHashTableIter iter;
+	gpointer value;
+	FILE *fp = perf.fp;
+	int i;
+
+	if (!ug_perf_enabled)
+		return;
+
+	/* averages per call; ipc is instructions / cycles */
+	fprintf(fp, "# pid %d\n# %-30s %-10s %8s", getpid(), "name", "op",
+		"calls");
+	for (i = 0; i < UG_PERF_MAX; i++)
+		fprintf(fp, " %14s", ug_perf_events[i].name);
+	fprintf(fp, " %6s\n", "ipc");
+
+	g_hash_table_iter_init(&iter, perf.table);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		ug_perf_module_write(fp, value);
+
+	fprintf(fp, "\n");
+	fflush(fp);
+}
+
+static Eina_Bool ug_perf_signal_cb(void *data, int type, void *event)
+{
+	Ecore_Event_Signal_User *e = event;
+
+	if (e->number == 2)
+		ug_perf_dump();
+
+	return ECORE_CALLBACK_PASS_ON;
+}
+
+static void ug_perf_module_free(gpointer data)
+{
+	struct ug_perf_module *m = data;
+
+	free(m->name);
+	free(m);
+}
+
+int ug_perf_init(void)
+{
+	const char *env;
+	char buf[64];
+	int fd;
+	int i;
+
+	if (ug_perf_enabled)
+		return 0;
+
+	env = getenv("UG_PERF");
+	if (!env || !*env || !strcmp(env, "0"))
+		return 0;
+
+	if (!strcmp(env, "1")) {
+		snprintf(buf, sizeof(buf), UG_PERF_FILE_FMT, getpid());
+		env = buf;
+	}
+
+	/* counters the kernel or the cpu lack are left out */
+	for (i = 0; i < UG_PERF_MAX; i++) {
+		fd = ug_perf_open(i, perf.n ? perf.fds[0] : -1);
+		if (fd < 0) {
+			_WRN("perf counter %s is not available: %s",
+			     ug_perf_events[i].name, strerror(errno));
+			continue;
+		}
+		perf.fds[perf.n] = fd;
+		perf.counters[perf.n] = i;
+		perf.n++;
+	}
+
+	if (!perf.n)
+		return -1;
+
+	perf.path = strdup(env);
+	perf.table = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+					   ug_perf_module_free);
+	if (!perf.path || !perf.table)
+		goto err;
+
+	/* dumps are appended, the file is kept open */
+	perf.fp = ug_file_create(perf.path);
+	if (!perf.fp) {
+		_ERR("perf file(%s) open failed: %s", perf.path,
+		     strerror(errno));
+		goto err;
+	}
+
+	ioctl(perf.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(perf.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	perf.signal_handler = ecore_event_handler_add(ECORE_EVENT_SIGNAL_USER,
+						      ug_perf_signal_cb, NULL);
+	ug_perf_enabled = 1;
+
+	_DBG("perf counters to %s", perf.path);
+	return 0;
+
+ err:
+	for (i = 0; i < perf.n; i++)
+		close(perf.fds[i]);
+	perf.n = 0;
+	if (perf.table)
+		g_hash_table_destroy(perf.table);
+	perf.table = NULL;
+	free(perf.path);
+	perf.path = NULL;
+	return -1;
+}
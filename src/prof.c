@@ -0,0 +1,414 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <execinfo.h>
+#include <sys/syscall.h>
+
+#include <glib.h>
+#include <Ecore.h>
+
+#include "ug.h"
+#include "ug-prof.h"
+#include "ug-dbg.h"
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+#define UG_PROF_FILE_FMT "/tmp/ug-prof-%d.folded"
+#define UG_PROF_HZ_DEFAULT 99
+#define UG_PROF_HZ_MAX 10000
+
+/* about 40 seconds at the default rate between two drains */
+#define UG_PROF_SAMPLES 4096
+#define UG_PROF_FRAMES 48
+#define UG_PROF_DEPTH_MAX 16
+
+/* the handler and the signal trampoline */
+#define UG_PROF_SKIP 2
+
+/* drained into the folded table from the main loop */
+#define UG_PROF_DRAIN_INTERVAL 1.0
+
+struct ug_prof_sample {
+	const char *name;
+	const char *what;
+	int n;
+	void *frames[UG_PROF_FRAMES];
+};
+
+struct ug_prof_tag {
+	const char *name;
+	const char *what;
+};
+
+struct ug_prof {
+	/* written by the signal handler only */
+	struct ug_prof_sample *ring;
+	unsigned int head;
+	unsigned int dropped;
+	/* read by the signal handler */
+	struct ug_prof_tag stack[UG_PROF_DEPTH_MAX];
+	volatile int depth;
+	struct ug_prof_tag effect;
+
+	unsigned int tail;
+
+	/* gadget names, kept for the samples that refer to them */
+	GHashTable *names;
+	/* frame address -> symbol */
+	GHashTable *symbols;
+	/* folded stack -> count */
+	GHashTable *folded;
+
+	timer_t timer;
+	char *path;
+	FILE *fp;
+	Ecore_Timer *drain_timer;
+	Ecore_Event_Handler *signal_handler;
+};
+
+static struct ug_prof prof;
+
+UG_INTERNAL_API int ug_prof_enabled;
+
+static const char *ug_prof_intern(const char *name)
+{
+	char *s;
+
+	if (!name)
+		return NULL;
+
+	s = g_hash_table_lookup(prof.names, name);
+	if (!s) {
+		s = strdup(name);
+		if (!s)
+			return NULL;
+		g_hash_table_insert(prof.names, s, s);
+	}
+
+	return s;
+}
+
+UG_INTERNAL_API void ug_prof_enter(ui_gadget_h ug, const char *what)
+{
+	struct ug_prof_tag *t;
+	int depth = prof.depth;
+
+	if (depth < UG_PROF_DEPTH_MAX) {
+		t = &prof.stack[depth];
+		t->name = ug_prof_intern(ug ? ug->name : NULL);
+		t->what = what;
+	}
+
+	/* the tag is complete before the handler can see it */
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	prof.depth = depth + 1;
+}
+
+UG_INTERNAL_API void ug_prof_leave(void)
+{
+	if (prof.depth > 0)
+		prof.depth--;
+}
+
+UG_INTERNAL_API void ug_prof_effect(ui_gadget_h ug, int running)
+{
+	/* cleared first, so the handler never sees a torn tag */
+	prof.effect.name = NULL;
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+	if (!running || !ug)
+		return;
+
+	prof.effect.what = "effect";
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	prof.effect.name = ug_prof_intern(ug->name);
+}
+
+/* async-signal-safe, backtrace() is warmed up in ug_prof_init() */
+static void ug_prof_signal_handler(int signo)
+{
+	struct ug_prof_sample *s;
+	int saved_errno = errno;
+	int depth = prof.depth;
+
+	if (prof.head - prof.tail >= UG_PROF_SAMPLES) {
+		prof.dropped++;
+		goto out;
+	}
+
+	s = &prof.ring[prof.head % UG_PROF_SAMPLES];
+	if (depth > UG_PROF_DEPTH_MAX)
+		depth = UG_PROF_DEPTH_MAX;
+	if (depth) {
+		s->name = prof.stack[depth - 1].name;
+		s->what = prof.stack[depth - 1].what;
+	} else {
+		s->name = prof.effect.name;
+		s->what = s->name ? prof.effect.what : NULL;
+	}
+	s->n = backtrace(s->frames, UG_PROF_FRAMES);
+
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	prof.head++;
+
+ out:
+	errno = saved_errno;
+}
+
+static const char *ug_prof_symbol(void *addr)
+{
+	const char *base;
+	Dl_info info;
+	char buf[256];
+	char *s;
+
+	s = g_hash_table_lookup(prof.symbols, addr);
+	if (s)
+		return s;
+
+	if (!dladdr(addr, &info))
+		memset(&info, 0, sizeof(info));
+
+	if (info.dli_sname) {
+		snprintf(buf, sizeof(buf), "%s", info.dli_sname);
+	} else if (info.dli_fname) {
+		base = strrchr(info.dli_fname, '/');
+		snprintf(buf, sizeof(buf), "%s+0x%lx",
+			 base ? base + 1 : info.dli_fname,
+			 (unsigned long)((char *)addr - (char *)info.dli_fbase));
+	} else {
+		snprintf(buf, sizeof(buf), "%p", addr);
+	}
+
+	s = strdup(buf);
+	if (s)
+		g_hash_table_insert(prof.symbols, addr, s);
+
+	return s ? s : "?";
+}
+
+static void ug_prof_fold(struct ug_prof_sample *s)
+{
+	unsigned long long *count;
+	GString *key;
+	int i;
+
+	/* root first: gadget, what it was doing, then the stack */
+	key = g_string_new(s->name ? s->name : "-");
+	if (s->what) {
+		g_string_append_c(key, ';');
+		g_string_append(key, s->what);
+	}
+	for (i = s->n - 1; i >= UG_PROF_SKIP; i--) {
+		g_string_append_c(key, ';');
+		g_string_append(key, ug_prof_symbol(s->frames[i]));
+	}
+
+	count = g_hash_table_lookup(prof.folded, key->str);
+	if (!count) {
+		count = calloc(1, sizeof(unsigned long long));
+		if (!count) {
+			g_string_free(key, TRUE);
+			return;
+		}
+		g_hash_table_insert(prof.folded, g_string_free(key, FALSE),
+				    count);
+	} else {
+		g_string_free(key, TRUE);
+	}
+
+	(*count)++;
+}
+
+static void ug_prof_drain(void)
+{
+	unsigned int head = prof.head;
+
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+	while (prof.tail != head) {
+		ug_prof_fold(&prof.ring[prof.tail % UG_PROF_SAMPLES]);
+		__atomic_signal_fence(__ATOMIC_SEQ_CST);
+		prof.tail++;
+	}
+}
+
+static Eina_Bool ug_prof_drain_cb(void *data)
+{
+	ug_prof_drain();
+	return ECORE_CALLBACK_RENEW;
+}
+
+void ug_prof_dump(void)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	FILE *fp = prof.fp;
+
+	if (!ug_prof_enabled)
+		return;
+
+	ug_prof_drain();
+
+	/* counts are cumulative, each dump replaces the last */
+	rewind(fp);
+	if (ftruncate(fileno(fp), 0))
+		_WRN("profile file(%s) truncate failed: %s", prof.path,
+		     strerror(errno));
+
+	g_hash_table_iter_init(&iter, prof.folded);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		fprintf(fp, "%s %llu\n", (char *)key,
+			*(unsigned long long *)value);
+
+	fflush(fp);
+
+	if (prof.dropped)
+		_WRN("profile: %u samples dropped", prof.dropped);
+}
+
+static Eina_Bool ug_prof_signal_cb(void *data, int type, void *event)
+{
+	Ecore_Event_Signal_User *e = event;
+
+	if (e->number == 2)
+		ug_prof_dump();
+
+	return ECORE_CALLBACK_PASS_ON;
+}
+
+int ug_prof_init(void)
+{
+	struct itimerspec its;
+	struct sigaction sa;
+	struct sigevent sev;
+	const char *env;
+	char buf[64];
+	void *frame;
+	long hz;
+
+	if (ug_prof_enabled)
+		return 0;
+
+	env = getenv("UG_PROF");
+	if (!env || !*env || !strcmp(env, "0"))
+		return 0;
+
+	if (!strcmp(env, "1")) {
+		snprintf(buf, sizeof(buf), UG_PROF_FILE_FMT, getpid());
+		env = buf;
+	}
+
+	prof.ring = calloc(UG_PROF_SAMPLES, sizeof(struct ug_prof_sample));
+	prof.path = strdup(env);
+	prof.names = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+					   NULL);
+	prof.symbols = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+					     NULL, free);
+	prof.folded = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					    free);
+	if (!prof.ring || !prof.path || !prof.names || !prof.symbols ||
+	    !prof.folded)
+		goto err;
+
+	prof.fp = ug_file_create(prof.path);
+	if (!prof.fp) {
+		_ERR("profile file(%s) open failed: %s", prof.path,
+		     strerror(errno));
+		goto err;
+	}
+
+	hz = UG_PROF_HZ_DEFAULT;
+	env = getenv("UG_PROF_HZ");
+	if (env && atol(env) > 0 && atol(env) <= UG_PROF_HZ_MAX)
+		hz = atol(env);
+
+	/* loads the unwinder now, not in the signal handler */
+	backtrace(&frame, 1);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = ug_prof_signal_handler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(SIGPROF, &sa, NULL)) {
+		_ERR("profile: sigaction failed: %s", strerror(errno));
+		goto err;
+	}
+
+	/* CPU time of the main loop thread, and the signal goes to it */
+	memset(&sev, 0, sizeof(sev));
+	sev.sigev_notify = SIGEV_THREAD_ID;
+	sev.sigev_signo = SIGPROF;
+	sev.sigev_notify_thread_id = syscall(SYS_gettid);
+	if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &prof.timer)) {
+		_ERR("profile: timer_create failed: %s", strerror(errno));
+		goto err;
+	}
+
+	its.it_interval.tv_sec = 1 / hz;
+	its.it_interval.tv_nsec = hz > 1 ? 1000000000L / hz : 0;
+	its.it_value = its.it_interval;
+	if (timer_settime(prof.timer, 0, &its, NULL)) {
+		_ERR("profile: timer_settime failed: %s", strerror(errno));
+		timer_delete(prof.timer);
+		goto err;
+	}
+
+	prof.drain_timer = ecore_timer_add(UG_PROF_DRAIN_INTERVAL,
+					   ug_prof_drain_cb, NULL);
+	prof.signal_handler = ecore_event_handler_add(ECORE_EVENT_SIGNAL_USER,
+						      ug_prof_signal_cb, NULL);
+	ug_prof_enabled = 1;
+
+	_DBG("profile to %s at %ld Hz", prof.path, hz);
+	return 0;
+
+ err:
+	if (prof.fp)
+		fclose(prof.fp);
+	if (prof.names)
+		g_hash_table_destroy(prof.names);
+	if (prof.symbols)
+		g_hash_table_destroy(prof.symbols);
+	if (prof.folded)
+		g_hash_table_destroy(prof.folded);
+	free(prof.ring);
+	free(prof.path);
+	prof.ring = NULL;
+	prof.path = NULL;
+	prof.fp = NULL;
+	prof.names = NULL;
+	prof.symbols = NULL;
+	prof.folded = NULL;
+	return -1;
+}
@@ -0,0 +1,284 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "ug.h"
+#include "ug-sched.h"
+#include "ug-trace.h"
+#include "ug-metrics.h"
+#include "ug-dbg.h"
+
+struct ug_sched_job {
+	Ecore_Task_Cb func;
+	void *data;
+	const char *name;
+	/* for the background aging and the lag metrics of ug-metrics.h */
+	unsigned long long queued;
+	int metrics_job;
+	int ran;
+	struct ug_sched_job *next;
+};
+
+struct ug_sched_queue {
+	struct ug_sched_job *head;
+	struct ug_sched_job *tail;
+};
+
+struct ug_sched {
+	struct ug_sched_queue queue[UG_SCHED_PRIO_MAX];
+	/* urgent and normal work: next iteration, then frame by frame */
+	Ecore_Job *job;
+	Ecore_Animator *animator;
+	/* background work */
+	Ecore_Idler *idler;
+	unsigned long long budget;
+	int running;
+};
+
+static struct ug_sched sched = {
+	.budget = UG_SCHED_BUDGET_MS * 1000000ULL,
+};
+
+static unsigned long long ug_sched_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void ug_sched_push(struct ug_sched_queue *q, struct ug_sched_job *j)
+{
+	j->next = NULL;
+	if (q->tail)
+		q->tail->next = j;
+	else
+		q->head = j;
+	q->tail = j;
+}
+
+static struct ug_sched_job *ug_sched_pop(struct ug_sched_queue *q)
+{
+	struct ug_sched_job *j = q->head;
+
+	if (j) {
+		q->head = j->next;
+		if (!q->head)
+			q->tail = NULL;
+	}
+
+	return j;
+}
+
+static int ug_sched_aged(struct ug_sched_job *j, unsigned long long now)
+{
+	return now - j->queued >=
+	    (unsigned long long)(UG_SCHED_BACKGROUND_AGE * 1000000000.0);
+}
+
+static Eina_Bool ug_sched_run(struct ug_sched_job *j)
+{
+	Eina_Bool r;
+
+	UG_METRICS_INC(idlers_run);
+	if (!j->ran) {
+		ug_metrics_job_run(j->metrics_job, ug_sched_now() - j->queued);
+		j->ran = 1;
+	}
+
+	UG_TRACE_BEGIN(UG_TRACE_CAT_IDLER, j->name, NULL);
+	r = j->func(j->data);
+	UG_TRACE_END(UG_TRACE_CAT_IDLER, j->name, NULL);
+
+	if (r == ECORE_CALLBACK_CANCEL) {
+		UG_METRICS_DEC(idlers);
+		ug_metrics_job_done(j->metrics_job);
+		free(j);
+	}
+
+	return r;
+}
+
+/*
+ * Urgent jobs all run. Normal jobs run until the budget is spent, at
+ * least one per dispatch so they always progress. Background jobs run
+ * from the idler, or from a frame once the oldest one has waited too
+ * long. Renewed jobs wait for the next dispatch.
+ */
+static void ug_sched_dispatch(int idle)
+{
+	struct ug_sched_queue renewed[UG_SCHED_PRIO_MAX] = { { NULL, NULL } };
+	struct ug_sched_queue *q;
+	struct ug_sched_job *j;
+	unsigned long long now = ug_sched_now();
+	unsigned long long deadline = now + sched.budget;
+	int prio;
+	int ran = 0;
+
+	sched.running = 1;
+
+	for (prio = 0; prio < UG_SCHED_PRIO_MAX; prio++) {
+		q = &sched.queue[prio];
+		while (q->head) {
+			if (prio != UG_SCHED_URGENT) {
+				now = ug_sched_now();
+				if (ran && now >= deadline)
+					goto out;
+				if (prio == UG_SCHED_BACKGROUND && !idle
+				    && !ug_sched_aged(q->head, now))
+					goto out;
+				ran++;
+			}
+
+			j = ug_sched_pop(q);
+			if (ug_sched_run(j) == ECORE_CALLBACK_RENEW) {
+				j->queued = ug_sched_now();
+				ug_sched_push(&renewed[prio], j);
+			}
+
+			/* one aged background job per frame */
+			if (prio == UG_SCHED_BACKGROUND && !idle)
+				goto out;
+		}
+	}
+
+ out:
+	for (prio = 0; prio < UG_SCHED_PRIO_MAX; prio++) {
+		while ((j = ug_sched_pop(&renewed[prio])))
+			ug_sched_push(&sched.queue[prio], j);
+	}
+
+	sched.running = 0;
+}
+
+static void ug_sched_kick(void);
+
+static void ug_sched_job_cb(void *data)
+{
+	sched.job = NULL;
+	ug_sched_dispatch(0);
+	ug_sched_kick();
+}
+
+static Eina_Bool ug_sched_animator_cb(void *data)
+{
+	ug_sched_dispatch(0);
+
+	if (!sched.queue[UG_SCHED_NORMAL].head
+	    && !sched.queue[UG_SCHED_BACKGROUND].head) {
+		sched.animator = NULL;
+		ug_sched_kick();
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	ug_sched_kick();
+	return ECORE_CALLBACK_RENEW;
+}
+
+static Eina_Bool ug_sched_idler_cb(void *data)
+{
+	ug_sched_dispatch(1);
+
+	if (!sched.queue[UG_SCHED_URGENT].head
+	    && !sched.queue[UG_SCHED_NORMAL].head
+	    && !sched.queue[UG_SCHED_BACKGROUND].head) {
+		sched.idler = NULL;
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	ug_sched_kick();
+	return ECORE_CALLBACK_RENEW;
+}
+
+static void ug_sched_kick(void)
+{
+	struct ug_sched_queue *q = sched.queue;
+
+	/* jobs added while dispatching are picked up at its end */
+	if (sched.running)
+		return;
+
+	if ((q[UG_SCHED_URGENT].head || q[UG_SCHED_NORMAL].head) && !sched.job)
+		sched.job = ecore_job_add(ug_sched_job_cb, NULL);
+
+	/* frames keep normal work going and age background work */
+	if ((q[UG_SCHED_NORMAL].head || q[UG_SCHED_BACKGROUND].head)
+	    && !sched.animator)
+		sched.animator = ecore_animator_add(ug_sched_animator_cb, NULL);
+
+	if (!sched.idler)
+		sched.idler = ecore_idler_add(ug_sched_idler_cb, NULL);
+}
+
+UG_INTERNAL_API struct ug_sched_job *ug_sched_add(enum ug_sched_prio prio,
+						  Ecore_Task_Cb func,
+						  const void *data,
+						  const char *name)
+{
+	struct ug_sched_job *j;
+
+	if (!func || (unsigned int)prio >= UG_SCHED_PRIO_MAX) {
+		_ERR("ug_sched_add failed: invalid job(%s) prio(%d)",
+		     name, prio);
+		return NULL;
+	}
+
+	j = malloc(sizeof(struct ug_sched_job));
+	if (!j) {
+		_ERR("ug_sched_add failed: job(%s) out of memory", name);
+		return NULL;
+	}
+
+	j->func = func;
+	j->data = (void *)data;
+	j->name = name;
+	j->queued = ug_sched_now();
+	j->metrics_job = ug_metrics_job(name);
+	j->ran = 0;
+	UG_METRICS_INC(idlers);
+
+	ug_sched_push(&sched.queue[prio], j);
+	ug_sched_kick();
+
+	return j;
+}
+
+int ug_sched_init(void)
+{
+	const char *env;
+	double ms;
+
+	env = getenv("UG_SCHED_BUDGET_MS");
+	if (!env || !*env)
+		return 0;
+
+	ms = strtod(env, NULL);
+	if (ms <= 0) {
+		_WRN("invalid UG_SCHED_BUDGET_MS(%s)", env);
+		return -1;
+	}
+
+	sched.budget = ms * 1000000.0;
+
+	return 0;
+}
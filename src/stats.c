@@ -0,0 +1,174 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <glib.h>
+
+#include "ug.h"
+#include "ug-stats.h"
+#include "ug-dbg.h"
+
+struct ug_stats_series {
+	unsigned int count;
+	unsigned long long min;
+	unsigned long long sum;
+	/* the last UG_STATS_WINDOW latencies, for the percentile */
+	unsigned long long window[UG_STATS_WINDOW];
+};
+
+struct ug_stats_module {
+	unsigned int count;
+	struct ug_stats_series edges[UG_STATS_EDGE_MAX];
+};
+
+/* name -> struct ug_stats_module */
+static GHashTable *ug_stats_table;
+
+unsigned long long ug_stats_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+UG_INTERNAL_API void ug_stats_mark(ui_gadget_h ug, enum ug_stats_edge edge)
+{
+	if (!ug || edge < 0 || edge >= UG_STATS_EDGE_MAX)
+		return;
+
+	ug->stats.edges[edge] = ug_stats_now();
+}
+
+static void ug_stats_series_add(struct ug_stats_series *s,
+				unsigned long long ns)
+{
+	if (!s->count || ns < s->min)
+		s->min = ns;
+
+	s->window[s->count % UG_STATS_WINDOW] = ns;
+	s->sum += ns;
+	s->count++;
+}
+
+void ug_stats_fold(ui_gadget_h ug)
+{
+	struct ug_stats_module *m;
+	unsigned long long base;
+	unsigned long long *ts;
+	char *key;
+	int i;
+
+	if (!ug || !ug->name)
+		return;
+
+	if (!ug_stats_table) {
+		ug_stats_table = g_hash_table_new_full(g_str_hash, g_str_equal,
+						       free, free);
+		if (!ug_stats_table)
+			return;
+	}
+
+	m = g_hash_table_lookup(ug_stats_table, ug->name);
+	if (!m) {
+		m = calloc(1, sizeof(struct ug_stats_module));
+		if (!m)
+			return;
+		key = strdup(ug->name);
+		if (!key) {
+			free(m);
+			return;
+		}
+		g_hash_table_insert(ug_stats_table, key, m);
+	}
+
+	m->count++;
+	ts = ug->stats.edges;
+
+	for (i = 0; i < UG_STATS_EDGE_MAX; i++) {
+		base = i < UG_STATS_EDGE_DESTROY_REQUESTED ?
+		    ts[UG_STATS_EDGE_LOAD_REQUESTED] :
+		    ts[UG_STATS_EDGE_DESTROY_REQUESTED];
+
+		/* not reached, or reached out of order */
+		if (!ts[i] || !base || ts[i] < base)
+			continue;
+
+		ug_stats_series_add(&m->edges[i], ts[i] - base);
+	}
+}
+
+static int ug_stats_cmp(const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *)a;
+	unsigned long long y = *(const unsigned long long *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static unsigned long long ug_stats_series_p99(struct ug_stats_series *s)
+{
+	unsigned long long sorted[UG_STATS_WINDOW];
+	unsigned int n;
+	unsigned int rank;
+
+	n = s->count < UG_STATS_WINDOW ? s->count : UG_STATS_WINDOW;
+	memcpy(sorted, s->window, n * sizeof(unsigned long long));
+	qsort(sorted, n, sizeof(unsigned long long), ug_stats_cmp);
+
+	/* nearest rank */
+	rank = (n * 99 + 99) / 100;
+	return sorted[rank - 1];
+}
+
+int ug_stats_module_get(const char *name, struct ug_module_stats *stats)
+{
+	struct ug_stats_module *m = NULL;
+	struct ug_stats_series *s;
+	int i;
+
+	if (ug_stats_table)
+		m = g_hash_table_lookup(ug_stats_table, name);
+	if (!m) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	memset(stats, 0, sizeof(struct ug_module_stats));
+	stats->count = m->count;
+
+	for (i = 0; i < UG_STATS_EDGE_MAX; i++) {
+		s = &m->edges[i];
+		if (!s->count)
+			continue;
+
+		stats->edges[i].count = s->count;
+		stats->edges[i].min = s->min;
+		stats->edges[i].avg = s->sum / s->count;
+		stats->edges[i].p99 = ug_stats_series_p99(s);
+	}
+
+	return 0;
+}
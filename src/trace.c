@@ -0,0 +1,237 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+
+#include <glib.h>
+#include <Ecore.h>
+
+#include "ug.h"
+#include "ug-trace.h"
+#include "ug-dbg.h"
+
+/* events kept in memory before they are written out */
+#define UG_TRACE_BUF_MAX 16384
+
+struct ug_trace_ev {
+	unsigned long long ts;
+	const char *cat;
+	const char *name;
+	/* interned, the gadget may be gone when the event is written */
+	const char *ug_name;
+	const void *ug;
+	pid_t tid;
+	char ph;
+};
+
+struct ug_trace {
+	FILE *fp;
+	pid_t pid;
+	struct ug_trace_ev *buf;
+	unsigned int count;
+	/* gadget names seen so far */
+	GHashTable *names;
+	Ecore_Event_Handler *signal_handler;
+};
+
+static struct ug_trace trace;
+
+/* module loading is traced from worker threads as well */
+G_LOCK_DEFINE_STATIC(trace);
+
+UG_INTERNAL_API int ug_trace_enabled;
+
+static unsigned long long ug_trace_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static const char *ug_trace_intern(const char *name)
+{
+	char *s;
+
+	if (!name)
+		return NULL;
+
+	s = g_hash_table_lookup(trace.names, name);
+	if (!s) {
+		s = strdup(name);
+		if (!s)
+			return NULL;
+		g_hash_table_insert(trace.names, s, s);
+	}
+
+	return s;
+}
+
+/* gadget names are whatever the app passes, quote them as JSON */
+static void ug_trace_puts(const char *s)
+{
+	for (; s && *s; s++) {
+		if (*s == '"' || *s == '\\')
+			fprintf(trace.fp, "\\%c", *s);
+		else if ((unsigned char)*s < 0x20)
+			fprintf(trace.fp, "\\u%04x", *s);
+		else
+			putc(*s, trace.fp);
+	}
+}
+
+static void ug_trace_write(struct ug_trace_ev *ev)
+{
+	fprintf(trace.fp, "{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"",
+		ev->ph, ev->cat);
+	ug_trace_puts(ev->name);
+	fprintf(trace.fp, "\",\"ts\":%llu.%03llu,\"pid\":%d,\"tid\":%d",
+		ev->ts / 1000, ev->ts % 1000, trace.pid, ev->tid);
+
+	/* async spans are matched by id */
+	if (ev->ph == 'b' || ev->ph == 'e')
+		fprintf(trace.fp, ",\"id\":\"%p\"", ev->ug);
+
+	if (ev->ug) {
+		fprintf(trace.fp, ",\"args\":{\"ug\":\"");
+		ug_trace_puts(ev->ug_name);
+		fprintf(trace.fp, "\",\"ptr\":\"%p\"}", ev->ug);
+	}
+
+	fprintf(trace.fp, "},\n");
+}
+
+static void ug_trace_flush_locked(void)
+{
+	unsigned int i;
+
+	if (!trace.fp)
+		return;
+
+	for (i = 0; i < trace.count; i++)
+		ug_trace_write(&trace.buf[i]);
+
+	trace.count = 0;
+	fflush(trace.fp);
+}
+
+static void ug_trace_record(char ph, const char *cat, const char *name,
+			    const void *ug, const char *ug_name)
+{
+	struct ug_trace_ev *ev;
+	unsigned long long ts = ug_trace_now();
+
+	G_LOCK(trace);
+
+	if (!trace.buf)
+		goto out;
+
+	if (trace.count == UG_TRACE_BUF_MAX)
+		ug_trace_flush_locked();
+
+	ev = &trace.buf[trace.count++];
+	ev->ts = ts;
+	ev->cat = cat;
+	ev->name = name;
+	ev->ug = ug;
+	ev->ug_name = ug_trace_intern(ug_name);
+	ev->tid = syscall(SYS_gettid);
+	ev->ph = ph;
+
+ out:
+	G_UNLOCK(trace);
+}
+
+UG_INTERNAL_API void ug_trace_event(char ph, const char *cat,
+				    const char *name, ui_gadget_h ug)
+{
+	ug_trace_record(ph, cat, name, ug, ug ? ug->name : NULL);
+}
+
+void ug_trace_flush(void)
+{
+	G_LOCK(trace);
+	ug_trace_flush_locked();
+	G_UNLOCK(trace);
+}
+
+static Eina_Bool ug_trace_signal_cb(void *data, int type, void *event)
+{
+	Ecore_Event_Signal_User *e = event;
+
+	if (e->number == 2)
+		ug_trace_flush();
+
+	return ECORE_CALLBACK_PASS_ON;
+}
+
+int ug_trace_init(void)
+{
+	const char *path;
+
+	if (trace.fp)
+		return 0;
+
+	path = getenv("UG_TRACE");
+	if (!path || !*path)
+		return 0;
+
+	trace.buf = calloc(UG_TRACE_BUF_MAX, sizeof(struct ug_trace_ev));
+	trace.names = g_hash_table_new_full(g_str_hash, g_str_equal,
+					    free, NULL);
+	if (!trace.buf || !trace.names)
+		goto err;
+
+	trace.fp = ug_file_create(path);
+	if (!trace.fp) {
+		_ERR("trace file(%s) open failed: %s", path, strerror(errno));
+		goto err;
+	}
+
+	/* the closing bracket is optional in the JSON array format */
+	trace.pid = getpid();
+	fprintf(trace.fp, "[\n{\"ph\":\"M\",\"name\":\"process_name\","
+		"\"pid\":%d,\"args\":{\"name\":\"ui-gadget\"}},\n", trace.pid);
+
+	trace.signal_handler = ecore_event_handler_add(ECORE_EVENT_SIGNAL_USER,
+						       ug_trace_signal_cb,
+						       NULL);
+	ug_trace_enabled = 1;
+
+	_DBG("trace to %s", path);
+	return 0;
+
+ err:
+	if (trace.names)
+		g_hash_table_destroy(trace.names);
+	free(trace.buf);
+	trace.names = NULL;
+	trace.buf = NULL;
+	return -1;
+}
@@ -21,17 +21,79 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "ug.h"
 #include "ug-module.h"
 #include "ug-manager.h"
+#include "ug-stats.h"
+#include "ug-opstats.h"
+#include "ug-perf.h"
+#include "ug-prof.h"
+#include "ug-sched.h"
+#include "ug-trace.h"
 #include "ug-dbg.h"
 
-#ifndef UG_API
-#define UG_API __attribute__ ((visibility("default")))
-#endif
+UG_INTERNAL_API int ug_log_level = UG_LOG_LEVEL_DEBUG;
+
+static void ug_log_level_init(void)
+{
+	const char *names[UG_LOG_LEVEL_MAX] = {
+		"none", "error", "warn", "info", "debug"
+	};
+	const char *env;
+	char *end;
+	long level;
+	int i;
+
+	env = getenv("UG_LOG_LEVEL");
+	if (!env || !*env)
+		return;
+
+	level = strtol(env, &end, 10);
+	if (!*end && level >= UG_LOG_LEVEL_NONE && level < UG_LOG_LEVEL_MAX) {
+		ug_log_level = level;
+		return;
+	}
+
+	for (i = 0; i < UG_LOG_LEVEL_MAX; i++) {
+		if (!strcasecmp(env, names[i])) {
+			ug_log_level = i;
+			return;
+		}
+	}
+}
+
+/*
+ * Output files of the tracers and profilers are created afresh by the
+ * process, often under a predictable name in /tmp: a stale file of an
+ * earlier process with the same pid is removed, and a symlink or a file
+ * someone else planted there makes the open fail instead of being
+ * followed or truncated.
+ */
+FILE *ug_file_create(const char *path)
+{
+	FILE *fp;
+	int fd;
+
+	if (unlink(path) && errno != ENOENT)
+		_WRN("stale file(%s) remove failed: %s", path, strerror(errno));
+
+	fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+		  0600);
+	if (fd < 0)
+		return NULL;
+
+	fp = fdopen(fd, "w");
+	if (!fp)
+		close(fd);
+
+	return fp;
+}
 
 ui_gadget_h ug_root_create(void)
 {
@@ -44,8 +106,8 @@ ui_gadget_h ug_root_create(void)
 	}
 
 	ug->mode = UG_MODE_FULLVIEW;
-	ug->state = UG_STATE_RUNNING;
-	ug->children = NULL;
+	ug_metrics_node_add(ug);
+	ug_state_set(ug, UG_STATE_RUNNING);
 
 	return ug;
 }
@@ -58,6 +120,8 @@ int ug_free(ui_gadget_h ug)
 		return -1;
 	}
 
+	ug_metrics_node_del(ug);
+
 	if (ug->module) {
 		ug_module_unload(ug->module);
 	}
@@ -94,6 +158,43 @@ UG_API ui_gadget_h ug_create(ui_gadget_h parent,
 	return ugman_ug_load(parent, name, mode, service, cbs);
 }
 
+UG_API int ug_create_async(ui_gadget_h parent,
+				   const char *name,
+				   enum ug_mode mode,
+				   service_h service, struct ug_cbs *cbs)
+{
+	if (!name) {
+		_ERR("ug_create_async() failed: Invalid name");
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (mode < UG_MODE_FULLVIEW || mode >= UG_MODE_INVALID) {
+		_ERR("ug_create_async() failed: Invalid mode");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return ugman_ug_load_async(parent, name, mode, service, cbs);
+}
+
+UG_API int ug_preload(const char *names[], int count, int flags)
+{
+	if (!names || count <= 0) {
+		_ERR("ug_preload() failed: Invalid names");
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (flags & ~UG_PRELOAD_INIT) {
+		_ERR("ug_preload() failed: Invalid flags");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return ug_module_preload(names, count, flags);
+}
+
 UG_API int ug_init(Display *disp, Window xid, void *win, enum ug_option opt)
 {
 	if (!win || !xid || !disp) {
@@ -106,6 +207,20 @@ UG_API int ug_init(Display *disp, Window xid, void *win, enum ug_option opt)
 		return -1;
 	}
 
+	ug_log_level_init();
+	ug_trace_init();
+	ug_flight_init();
+	ug_metrics_init();
+	ug_opstats_init();
+	ug_perf_init();
+	ug_prof_init();
+
+	/* deferred work goes through it, there is no running without it */
+	if (ug_sched_init()) {
+		_ERR("ug_init() failed: scheduler init failed");
+		return -1;
+	}
+
 	return ugman_init(disp, xid, win, opt);
 }
 
@@ -242,6 +357,7 @@ UG_API int ug_send_result(ui_gadget_h ug, service_h send)
 		}
 	}
 
+	ug_metrics_message(send_dup, 1);
 	ug->cbs.result_cb(ug, send_dup, ug->cbs.priv);
 
 	if (send_dup)
@@ -278,6 +394,7 @@ UG_API int ug_send_result_full(ui_gadget_h ug, service_h send, service_result_e
 
 	service_add_extra_data(send_dup, UG_SERVICE_DATA_RESULT, (const char*)tmp_result);
 
+	ug_metrics_message(send_dup, 1);
 	ug->cbs.result_cb(ug, send_dup, ug->cbs.priv);
 
 	if (send_dup)
@@ -313,11 +430,101 @@ UG_API int ug_disable_effect(ui_gadget_h ug)
 		_ERR("ug_disable_effect() failed: ug has already been shown");
 		return -1;
 	}
-	ug->layout_state = UG_LAYOUT_NOEFFECT;
+	ug_layout_state_set(ug, UG_LAYOUT_NOEFFECT);
 
 	return 0;
 }
 
+UG_API int ug_set_log_level(enum ug_log_level level)
+{
+	if (level < UG_LOG_LEVEL_NONE || level >= UG_LOG_LEVEL_MAX) {
+		_ERR("ug_set_log_level() failed: Invalid level");
+		errno = EINVAL;
+		return -1;
+	}
+
+	ug_log_level = level;
+	return 0;
+}
+
+UG_API int ug_get_load_times(ui_gadget_h ug, struct ug_load_times *times)
+{
+	if (!ug || !ugman_ug_exist(ug) || !times) {
+		_ERR("ug_get_load_times() failed: Invalid argument");
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!ug->module) {
+		_ERR("ug_get_load_times() failed: module is not loaded");
+		return -1;
+	}
+
+	memcpy(times, &ug->module->times, sizeof(struct ug_load_times));
+	return 0;
+}
+
+UG_API int ug_get_stats(ui_gadget_h ug, struct ug_stats *stats)
+{
+	if (!ug || !ugman_ug_exist(ug) || !stats) {
+		_ERR("ug_get_stats() failed: Invalid argument");
+		errno = EINVAL;
+		return -1;
+	}
+
+	memcpy(stats, &ug->stats, sizeof(struct ug_stats));
+	return 0;
+}
+
+UG_API int ug_get_module_stats(const char *name, struct ug_module_stats *stats)
+{
+	if (!name || !stats) {
+		_ERR("ug_get_module_stats() failed: Invalid argument");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return ug_stats_module_get(name, stats);
+}
+
+UG_API int ug_get_module_op_stats(const char *name,
+				  struct ug_module_op_stats *stats)
+{
+	if (!name || !stats) {
+		_ERR("ug_get_module_op_stats() failed: Invalid argument");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return ug_opstats_module_get(name, stats);
+}
+
+UG_API int ug_foreach_module_op_stats(int (*func) (const char *name,
+				      const struct ug_module_op_stats *stats,
+				      void *data), void *data)
+{
+	if (!func) {
+		_ERR("ug_foreach_module_op_stats() failed: Invalid argument");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return ug_opstats_foreach(func, data);
+}
+
+UG_API unsigned long long ug_op_bucket_ns(int bucket)
+{
+	if (bucket < 0 || bucket >= UG_OP_HIST_BUCKETS)
+		return 0;
+
+	return ug_opstats_bucket_ns(bucket);
+}
+
+UG_API int ug_set_op_budget(unsigned long long budget_ns, int backtrace)
+{
+	return ug_opstats_budget_set(budget_ns, backtrace);
+}
+
 UG_API int ug_is_installed(const char *name)
 {
 	if(name == NULL){
@@ -19,12 +19,16 @@
  *
  */
 
-#include <glib.h>
 #include <Elementary.h>
 #include <ui-gadget-engine.h>
 
 #include "ug.h"
 #include "ug-efl-engine.h"
+#include "ug-stats.h"
+#include "ug-probe.h"
+#include "ug-trace.h"
+#include "ug-sched.h"
+#include "ug-prof.h"
 #include "ug-dbg.h"
 
 #ifndef UG_ENGINE_API
@@ -36,6 +40,7 @@ static Evas_Object *conform = NULL;
 static void on_show_cb(void *data, Evas *e, Evas_Object *obj, void *event_info);
 static void (*show_end_cb)(void* data) = NULL;
 static void (*hide_end_cb)(void* data) = NULL;
+static void __destroy_end_kick(ui_gadget_h child);
 
 static void _layout_del_cb(void *data, Evas_Object *obj, void *event_info)
 {
@@ -47,40 +52,62 @@ static void _layout_del_cb(void *data, Evas_Object *obj, void *event_info)
 
 	evas_object_event_callback_del(ug->layout, EVAS_CALLBACK_DEL, _layout_del_cb);
 
-	ug->layout_state = UG_LAYOUT_DESTROY;
+	ug_layout_state_set(ug, UG_LAYOUT_DESTROY);
 	ug->layout = NULL;
+	__destroy_end_kick(ug);
+}
+
+static int __children_hiding(ui_gadget_h ug)
+{
+	ui_gadget_h child;
+
+	for (child = ug->first_child; child; child = child->next_sibling) {
+		if (child->layout_state == UG_LAYOUT_HIDEEFFECT)
+			return 1;
+	}
+
+	return 0;
 }
 
 static Eina_Bool __destroy_end_cb(void *data)
 {
-	GSList *child;
 	ui_gadget_h ug = (ui_gadget_h)data;
 
 	_DBG("\t __destroy_end_cb ug=%p", ug);
 
-	if (ug->children) {
-		child = ug->children;
-		//_DBG("\t ug(%p) has children(%p)", ug, child);
-		while (child) {
-			if(!child->data) {
-				_ERR("child->data is null");
-				return ECORE_CALLBACK_CANCEL;
-			}
-
-			//_DBG("\t child(%p) layout_state(%d)", child, ((ui_gadget_h)child->data)->layout_state);
-
-			if( ((ui_gadget_h)child->data)->layout_state == UG_LAYOUT_HIDEEFFECT) {
-				//_DBG("\t wait hideeffect child(%p)", ug);
-				return ECORE_CALLBACK_RENEW;
-			}
-			child = g_slist_next(child);
-		}
+	/* the last child to leave its hide effect queues us again */
+	if (__children_hiding(ug)) {
+		_DBG("\t wait hideeffect children of ug(%p)", ug);
+		ug->destroy_end_wait = 1;
+		return ECORE_CALLBACK_CANCEL;
 	}
 
+	UG_TRACE_BEGIN(UG_TRACE_CAT_IDLER, "destroy_end", ug);
+	UG_PROF_ENTER(ug, "destroy_end");
 	hide_end_cb(ug);
+	UG_PROF_LEAVE();
+	UG_TRACE_END(UG_TRACE_CAT_IDLER, "destroy_end", NULL);
 	return ECORE_CALLBACK_CANCEL;
 }
 
+static void __destroy_end_schedule(ui_gadget_h ug)
+{
+	ug_sched_add(UG_SCHED_BACKGROUND, (Ecore_Task_Cb)__destroy_end_cb,
+		     (void *)ug, "destroy_end");
+}
+
+/* child left its hide effect: its parent may be waiting for that */
+static void __destroy_end_kick(ui_gadget_h child)
+{
+	ui_gadget_h ug = child->parent;
+
+	if (!ug || !ug->destroy_end_wait || __children_hiding(ug))
+		return;
+
+	ug->destroy_end_wait = 0;
+	__destroy_end_schedule(ug);
+}
+
 static void __del_effect_end(ui_gadget_h ug)
 {
 	if (navi) {
@@ -97,9 +124,10 @@ static void __del_effect_end(ui_gadget_h ug)
 		evas_object_event_callback_del(ug->layout, EVAS_CALLBACK_DEL, _layout_del_cb);
 	}
 
-	ecore_idler_add((Ecore_Task_Cb)__destroy_end_cb, (void *)ug);
+	__destroy_end_schedule(ug);
 
-	ug->layout_state = UG_LAYOUT_DESTROY;
+	ug_layout_state_set(ug, UG_LAYOUT_DESTROY);
+	__destroy_end_kick(ug);
 }
 
 static void __del_finished(void *data, Evas_Object *obj, void *event_info)
@@ -112,11 +140,15 @@ static void __del_finished(void *data, Evas_Object *obj, void *event_info)
 
 	evas_object_smart_callback_del(obj, "transition,finished",
 					__del_finished);
+	UG_TRACE_ASYNC_END(UG_TRACE_CAT_ENGINE, "hide_effect", ug);
+	UG_PROF_EFFECT(ug, 0);
 
+	UG_PROF_ENTER(ug, "hide_finished");
 	if(ug->layout_state == UG_LAYOUT_HIDEEFFECT)
 		__del_effect_end(ug);
 	else
 		_ERR("wrong ug(%p) state(%d)", ug, ug->layout_state);
+	UG_PROF_LEAVE();
 }
 
 static void __del_effect_top_layout(ui_gadget_h ug)
@@ -124,29 +156,19 @@ static void __del_effect_top_layout(ui_gadget_h ug)
 	_DBG("\t cb transition add ug=%p", ug);
 	evas_object_smart_callback_add(navi, "transition,finished",
 				__del_finished, ug);
+	UG_TRACE_ASYNC_BEGIN(UG_TRACE_CAT_ENGINE, "hide_effect", ug);
+	UG_PROF_EFFECT(ug, 1);
 	elm_naviframe_item_pop(navi);
 	ug->effect_layout = NULL;
-	ug->layout_state = UG_LAYOUT_HIDEEFFECT;
+	ug_layout_state_set(ug, UG_LAYOUT_HIDEEFFECT);
 }
 
-static void __del_effect_layout(ui_gadget_h ug, ui_gadget_h t_ug)
+static void __del_effect_layout_post(ui_gadget_h ug, void *data)
 {
-	GSList *child;
-
-	if (!ug)
-		return;
+	ui_gadget_h t_ug = data;
 
 	_DBG("\t ug=%p state=%d , t_ug=%p", ug, ug->layout_state, t_ug);
 
-	if (ug->children) {
-		child = ug->children;
-		_DBG("\t ug(%p) has children(%p)", ug, child);
-		while (child) {
-			__del_effect_layout(child->data, t_ug);
-			child = g_slist_next(child);
-		}
-	}
-
 	if((ug == t_ug)&&(ug->layout_state != UG_LAYOUT_NOEFFECT)){
 		if (ug->layout_state != UG_LAYOUT_HIDEEFFECT) {
 			__del_effect_top_layout(ug);
@@ -163,6 +185,12 @@ static void __del_effect_layout(ui_gadget_h ug, ui_gadget_h t_ug)
 	__del_effect_end(ug);
 }
 
+static void __del_effect_layout(ui_gadget_h ug, ui_gadget_h t_ug)
+{
+	/* children first, each ends up in __del_effect_end() */
+	ug_tree_walk(ug, NULL, __del_effect_layout_post, t_ug);
+}
+
 static void __hide_effect_end(ui_gadget_h ug)
 {
 	if (navi) {
@@ -179,7 +207,8 @@ static void __hide_effect_end(ui_gadget_h ug)
 		evas_object_hide(ug->layout);
 	}
 
-	ug->layout_state = UG_LAYOUT_HIDE;
+	ug_layout_state_set(ug, UG_LAYOUT_HIDE);
+	__destroy_end_kick(ug);
 }
 
 static void __hide_finished(void *data, Evas_Object *obj, void *event_info)
@@ -189,14 +218,19 @@ static void __hide_finished(void *data, Evas_Object *obj, void *event_info)
 		return;
 
 	_DBG("\t obj=%p ug=%p", obj, ug);
+	UG_PROBE(hide_finished, ug);
+	UG_TRACE_ASYNC_END(UG_TRACE_CAT_ENGINE, "hide_effect", ug);
+	UG_PROF_EFFECT(ug, 0);
 
 	evas_object_smart_callback_del(obj, "transition,finished",
 					__hide_finished);
 
+	UG_PROF_ENTER(ug, "hide_finished");
 	if(ug->layout_state == UG_LAYOUT_HIDEEFFECT)
 		__hide_effect_end(ug);
 	else
 		_ERR("wrong ug(%p) state(%d)", ug, ug->layout_state);
+	UG_PROF_LEAVE();
 }
 
 static void __on_hideonly_cb(void *data, Evas_Object *obj)
@@ -208,15 +242,17 @@ static void __on_hideonly_cb(void *data, Evas_Object *obj)
 
 	_DBG("\t obj=%p ug=%p layout_state=%d state=%d", obj, ug, ug->layout_state, ug->state);
 
+	UG_PROF_ENTER(ug, "hide");
 	evas_object_intercept_hide_callback_del(ug->layout, __on_hideonly_cb);
 	evas_object_event_callback_add(ug->layout, EVAS_CALLBACK_SHOW, on_show_cb, ug);
 
 	if (ug->layout_state == UG_LAYOUT_SHOW) {
-		ug->layout_state = UG_LAYOUT_HIDE;
+		ug_layout_state_set(ug, UG_LAYOUT_HIDE);
 	} else if (ug->layout_state == UG_LAYOUT_NOEFFECT) {
 		;
 	} else {
 		_ERR("wrong ug(%p) state(%d)", ug, ug->layout_state);
+		UG_PROF_LEAVE();
 		return;
 	}
 
@@ -224,14 +260,17 @@ static void __on_hideonly_cb(void *data, Evas_Object *obj)
 		_DBG("\t cb transition add ug=%p", ug);
 		evas_object_smart_callback_add(navi, "transition,finished",
 				__hide_finished, ug);
+		UG_TRACE_ASYNC_BEGIN(UG_TRACE_CAT_ENGINE, "hide_effect", ug);
+		UG_PROF_EFFECT(ug, 1);
 		elm_naviframe_item_pop(navi);
-		ug->layout_state = UG_LAYOUT_HIDEEFFECT;
+		ug_layout_state_set(ug, UG_LAYOUT_HIDEEFFECT);
 	} else {
 		elm_object_item_del(ug->effect_layout);
 		__hide_effect_end(ug);
 	}
 
 	ug->effect_layout = NULL;
+	UG_PROF_LEAVE();
 }
 
 static void on_destroy(ui_gadget_h ug, ui_gadget_h t_ug,
@@ -291,19 +330,25 @@ static void __show_finished(void *data, Evas_Object *obj, void *event_info)
 		return;
 
 	_DBG("\tobj=%p ug=%p", obj, ug);
+	UG_PROBE(show_finished, ug);
+	UG_TRACE_ASYNC_END(UG_TRACE_CAT_ENGINE, "show_effect", ug);
+	UG_PROF_EFFECT(ug, 0);
 
 	evas_object_smart_callback_del(obj, "transition,finished",
 					__show_finished);
 
+	UG_PROF_ENTER(ug, "show_finished");
 	if (ug->layout_state == UG_LAYOUT_DESTROY) {
 		_DBG("ug(%p) already destroyed", ug);
 	} else if (ug->layout_state == UG_LAYOUT_SHOWEFFECT) {
-		ug->layout_state = UG_LAYOUT_SHOW;
+		ug_layout_state_set(ug, UG_LAYOUT_SHOW);
+		ug_stats_mark(ug, UG_STATS_EDGE_SHOW_END);
 		if((show_end_cb)&&(ug->state == UG_STATE_CREATED))
 			show_end_cb(ug);
 	} else {
 		_ERR("wrong state(%d)", ug->layout_state);
 	}
+	UG_PROF_LEAVE();
 
 	return;
 }
@@ -315,6 +360,8 @@ static void on_show_cb(void *data, Evas *e, Evas_Object *obj,
 	if (!ug)
 		return;
 	_DBG("\tobj=%p ug=%p layout=%p state=%d", obj, ug, ug->layout, ug->layout_state);
+	UG_PROBE(show, ug);
+	UG_PROF_ENTER(ug, "show");
 
 	evas_object_event_callback_del(ug->layout, EVAS_CALLBACK_SHOW, on_show_cb);
 
@@ -328,7 +375,11 @@ static void on_show_cb(void *data, Evas *e, Evas_Object *obj,
 		|| ug->layout_state == UG_LAYOUT_HIDE
 	    || ug->layout_state == UG_LAYOUT_INIT) {
 		_DBG("\t UG_LAYOUT_Init(%d) obj=%p", ug->layout_state, obj);
-		ug->layout_state = UG_LAYOUT_SHOWEFFECT;
+		ug_layout_state_set(ug, UG_LAYOUT_SHOWEFFECT);
+		__destroy_end_kick(ug);
+		ug_stats_mark(ug, UG_STATS_EDGE_SHOW_BEGIN);
+		UG_TRACE_ASYNC_BEGIN(UG_TRACE_CAT_ENGINE, "show_effect", ug);
+		UG_PROF_EFFECT(ug, 1);
 
 		__update_indicator_overlap(ug->opt);
 
@@ -342,8 +393,11 @@ static void on_show_cb(void *data, Evas *e, Evas_Object *obj,
 		__update_indicator_overlap(ug->opt);
 
 		Elm_Object_Item *navi_top = elm_naviframe_top_item_get(navi);
+		ug_stats_mark(ug, UG_STATS_EDGE_SHOW_BEGIN);
 		ug->effect_layout = elm_naviframe_item_insert_after(navi,
 				navi_top, NULL, NULL, NULL, ug->layout, NULL);
+		/* no effect: shown as soon as it is in */
+		ug_stats_mark(ug, UG_STATS_EDGE_SHOW_END);
 		//ug start cb
 		if(show_end_cb)
 			show_end_cb(ug);
@@ -351,6 +405,7 @@ static void on_show_cb(void *data, Evas *e, Evas_Object *obj,
 		_ERR("\tlayout state error!! state=%d\n", ug->layout_state);
 	}
 
+	UG_PROF_LEAVE();
 	_DBG("\ton_show_cb end ug=%p", ug);
 }
 
@@ -394,7 +449,7 @@ static void *on_create(void *win, ui_gadget_h ug,
 	evas_object_event_callback_add(ug->layout, EVAS_CALLBACK_SHOW, on_show_cb, ug);
 	evas_object_event_callback_add(ug->layout, EVAS_CALLBACK_DEL, _layout_del_cb, ug);
 
-	ug->layout_state = UG_LAYOUT_INIT;
+	ug_layout_state_set(ug, UG_LAYOUT_INIT);
 
 	return conform;
 }
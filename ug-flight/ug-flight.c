@@ -0,0 +1,200 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * ug-flight: decodes a flight recorder dump (see ug-flight.h), oldest
+ * event first, with times relative to the dump.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ug-flight.h"
+
+/* follow enum ug_op in ug-op.h */
+static const char *op_names[] = {
+	"create", "start", "pause", "resume", "event", "message",
+	"key_event", "destroying", "destroy"
+};
+
+/* follow enum ug_state and enum ug_layout_state in ug.h */
+static const char *state_names[] = {
+	"ready", "created", "running", "stopped", "destroying", "destroyed"
+};
+
+static const char *layout_names[] = {
+	"init", "show", "showeffect", "hide", "hideeffect", "destroy",
+	"noeffect"
+};
+
+#define NAME(tab, i) \
+	((i) < sizeof(tab) / sizeof(tab[0]) ? tab[i] : "?")
+
+struct dump {
+	struct ug_flight_header hdr;
+	struct ug_flight_entry *entries;
+	char *names;
+};
+
+static int cmp_seq(const void *a, const void *b)
+{
+	const struct ug_flight_entry *x = a;
+	const struct ug_flight_entry *y = b;
+
+	return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+static int dump_read(struct dump *d, const char *path)
+{
+	size_t n;
+	FILE *fp;
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		perror(path);
+		return -1;
+	}
+
+	if (fread(&d->hdr, sizeof(d->hdr), 1, fp) != 1 ||
+	    d->hdr.magic != UG_FLIGHT_MAGIC) {
+		fprintf(stderr, "ug-flight: %s is not a flight dump\n", path);
+		goto err;
+	}
+
+	if (d->hdr.version != UG_FLIGHT_VERSION ||
+	    d->hdr.entry_size != sizeof(struct ug_flight_entry) ||
+	    !d->hdr.name_len) {
+		fprintf(stderr, "ug-flight: %s: unsupported version(%u)\n",
+			path, d->hdr.version);
+		goto err;
+	}
+
+	n = d->hdr.n_entries;
+	d->entries = calloc(n, sizeof(struct ug_flight_entry));
+	d->names = calloc(d->hdr.n_names + 1, d->hdr.name_len);
+	if (!d->entries || !d->names) {
+		fprintf(stderr, "ug-flight: out of memory\n");
+		goto err;
+	}
+
+	if (fread(d->entries, sizeof(struct ug_flight_entry), n, fp) != n ||
+	    fread(d->names, d->hdr.name_len, d->hdr.n_names, fp) !=
+	    d->hdr.n_names) {
+		fprintf(stderr, "ug-flight: %s is truncated\n", path);
+		goto err;
+	}
+
+	fclose(fp);
+	return 0;
+
+ err:
+	fclose(fp);
+	return -1;
+}
+
+static const char *dump_name(struct dump *d, uint32_t i)
+{
+	char *name;
+
+	if (!i || i >= d->hdr.n_names)
+		return "-";
+
+	name = d->names + (size_t)i * d->hdr.name_len;
+	name[d->hdr.name_len - 1] = '\0';
+	return name;
+}
+
+/* ns before the dump */
+static double dump_age(struct dump *d, uint64_t ticks)
+{
+	double ticks_span = (double)(d->hdr.ticks_dump - d->hdr.ticks_start);
+	double ns_span = (double)(d->hdr.mono_dump - d->hdr.mono_start);
+	double ns_per_tick = ticks_span > 0 ? ns_span / ticks_span : 1.0;
+
+	return ((double)d->hdr.ticks_dump - (double)ticks) * ns_per_tick;
+}
+
+static void entry_print(struct dump *d, struct ug_flight_entry *e)
+{
+	unsigned int op = e->op & ~UG_FLIGHT_LEAVE;
+	char what[64];
+
+	if (op < sizeof(op_names) / sizeof(op_names[0]))
+		snprintf(what, sizeof(what), "%s %s",
+			 e->op & UG_FLIGHT_LEAVE ? "leave" : "enter",
+			 op_names[op]);
+	else if (e->op == UG_FLIGHT_OP_STATE)
+		snprintf(what, sizeof(what), "state %s -> %s",
+			 NAME(state_names, e->state_old),
+			 NAME(state_names, e->state_new));
+	else if (e->op == UG_FLIGHT_OP_LAYOUT)
+		snprintf(what, sizeof(what), "layout %s -> %s",
+			 NAME(layout_names, e->layout_old),
+			 NAME(layout_names, e->layout_new));
+	else if (e->op == UG_FLIGHT_OP_LOAD)
+		snprintf(what, sizeof(what), "load");
+	else if (e->op == UG_FLIGHT_OP_DEL)
+		snprintf(what, sizeof(what), "del");
+	else
+		snprintf(what, sizeof(what), "op(%u)", e->op);
+
+	printf("%10u %12.3f ms  0x%-14llx %-24s %-32s [%s/%s]\n",
+	       e->seq - 1, -dump_age(d, e->ticks) / 1000000.0,
+	       (unsigned long long)e->ug, dump_name(d, e->name), what,
+	       NAME(state_names, e->state_new),
+	       NAME(layout_names, e->layout_new));
+}
+
+int main(int argc, char *argv[])
+{
+	struct dump d;
+	uint32_t i;
+	uint32_t n = 0;
+
+	if (argc != 2 || !strcmp(argv[1], "-h")) {
+		printf("Usage: ug-flight DUMP\n");
+		return argc == 2 ? 0 : 1;
+	}
+
+	memset(&d, 0, sizeof(d));
+	if (dump_read(&d, argv[1]))
+		return 1;
+
+	/* entries being written at the dump have seq 0 */
+	for (i = 0; i < d.hdr.n_entries; i++) {
+		if (d.entries[i].seq)
+			d.entries[n++] = d.entries[i];
+	}
+	qsort(d.entries, n, sizeof(struct ug_flight_entry), cmp_seq);
+
+	printf("pid %d, signal %d, %u events recorded, last %u shown\n\n",
+	       d.hdr.pid, d.hdr.signo, d.hdr.head, n);
+	printf("%10s %15s  %-16s %-24s %-32s %s\n", "event", "time",
+	       "ug", "name", "what", "[state/layout]");
+
+	for (i = 0; i < n; i++)
+		entry_print(&d, &d.entries[i]);
+
+	free(d.entries);
+	free(d.names);
+	return 0;
+}
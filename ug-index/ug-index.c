@@ -0,0 +1,338 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <linux/limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "ug-index.h"
+
+struct strtab {
+	char *buf;
+	uint32_t len;
+	uint32_t cap;
+};
+
+struct builder {
+	struct strtab str;
+
+	struct ug_index_dir *dirs;
+	uint32_t n_dirs;
+	uint32_t cap_dirs;
+
+	struct ug_index_entry *entries;
+	uint32_t n_entries;
+	uint32_t cap_entries;
+
+	int verbose;
+};
+
+static void *grow(void *ptr, uint32_t *cap, uint32_t need, size_t size)
+{
+	uint32_t n = *cap ? *cap : 16;
+	void *p;
+
+	if (need <= *cap)
+		return ptr;
+
+	while (n < need)
+		n *= 2;
+
+	p = realloc(ptr, n * size);
+	if (!p) {
+		fprintf(stderr, "ug-index: out of memory\n");
+		exit(1);
+	}
+
+	*cap = n;
+	return p;
+}
+
+static uint32_t str_add(struct strtab *t, const char *s)
+{
+	uint32_t off;
+	uint32_t len;
+
+	if (!s || !*s)
+		return 0;
+
+	len = strlen(s) + 1;
+	t->buf = grow(t->buf, &t->cap, t->len + len, 1);
+	off = t->len;
+	memcpy(t->buf + off, s, len);
+	t->len += len;
+
+	return off;
+}
+
+static int64_t dir_add(struct builder *b, const char *path, uint32_t pkg)
+{
+	struct ug_index_dir *d;
+	struct stat st;
+
+	b->dirs = grow(b->dirs, &b->cap_dirs, b->n_dirs + 1, sizeof(*d));
+	d = &b->dirs[b->n_dirs++];
+	d->path = str_add(&b->str, path);
+	d->pkg = pkg;
+
+	/* taken before the scan: a change during the scan makes it stale */
+	if (stat(path, &st) || !S_ISDIR(st.st_mode))
+		d->mtime = -1;
+	else
+		d->mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 +
+			   st.st_mtim.tv_nsec;
+
+	return d->mtime;
+}
+
+static void dir_scan(struct builder *b, const char *dir, uint32_t pkg,
+		     uint32_t rank)
+{
+	size_t pre = strlen(UG_INDEX_LIB_PREFIX);
+	size_t suf = strlen(UG_INDEX_LIB_SUFFIX);
+	struct ug_index_entry *e;
+	char path[PATH_MAX];
+	char name[NAME_MAX + 1];
+	struct dirent *de;
+	struct stat st;
+	size_t len;
+	DIR *dp;
+
+	dp = opendir(dir);
+	if (!dp)
+		return;
+
+	while ((de = readdir(dp))) {
+		len = strlen(de->d_name);
+		if (len <= pre + suf
+		    || strncmp(de->d_name, UG_INDEX_LIB_PREFIX, pre)
+		    || strcmp(de->d_name + len - suf, UG_INDEX_LIB_SUFFIX))
+			continue;
+
+		snprintf(path, PATH_MAX, "%s/%s", dir, de->d_name);
+		if (stat(path, &st) || !S_ISREG(st.st_mode))
+			continue;
+
+		memcpy(name, de->d_name + pre, len - pre - suf);
+		name[len - pre - suf] = '\0';
+
+		b->entries = grow(b->entries, &b->cap_entries,
+				  b->n_entries + 1, sizeof(*e));
+		e = &b->entries[b->n_entries++];
+		memset(e, 0, sizeof(*e));
+		e->hash = ug_index_hash(name);
+		e->name = str_add(&b->str, name);
+		e->path = str_add(&b->str, path);
+		e->pkg = pkg;
+		e->rank = rank;
+		e->size = st.st_size;
+		e->mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 +
+			   st.st_mtim.tv_nsec;
+
+		if (b->verbose)
+			printf("%s\t%s\n", name, path);
+	}
+
+	closedir(dp);
+}
+
+static void scan(struct builder *b)
+{
+	const char *roots[] = UG_INDEX_PKG_ROOTS;
+	const char *dirs[] = UG_INDEX_LIB_DIRS;
+	unsigned int n_roots = sizeof(roots) / sizeof(roots[0]);
+	char lib[PATH_MAX];
+	struct dirent *de;
+	struct stat st;
+	uint32_t pkg;
+	unsigned int i;
+	DIR *dp;
+
+	for (i = 0; i < n_roots; i++) {
+		dp = opendir(roots[i]);
+		if (!dp)
+			continue;
+
+		while ((de = readdir(dp))) {
+			if (de->d_name[0] == '.')
+				continue;
+
+			/* only existing package lib dirs are recorded */
+			snprintf(lib, PATH_MAX, "%s/%s/lib", roots[i],
+				 de->d_name);
+			if (stat(lib, &st) || !S_ISDIR(st.st_mode))
+				continue;
+
+			pkg = str_add(&b->str, de->d_name);
+			dir_add(b, lib, pkg);
+			dir_scan(b, lib, pkg, i);
+		}
+
+		closedir(dp);
+	}
+
+	for (i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+		if (dir_add(b, dirs[i], 0) < 0)
+			continue;
+		dir_scan(b, dirs[i], 0, n_roots + i);
+	}
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t r;
+
+	while (len) {
+		r = write(fd, p, len);
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		p += r;
+		len -= r;
+	}
+
+	return 0;
+}
+
+static int emit(struct builder *b, const char *out)
+{
+	struct ug_index_header hdr;
+	char tmp[PATH_MAX];
+	uint32_t *buckets;
+	uint32_t slot;
+	uint32_t i;
+	int fd;
+	int r;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = UG_INDEX_MAGIC;
+	hdr.version = UG_INDEX_VERSION;
+	hdr.n_dirs = b->n_dirs;
+	hdr.n_entries = b->n_entries;
+	hdr.n_buckets = 1;
+	while (hdr.n_buckets < b->n_entries * 2)
+		hdr.n_buckets <<= 1;
+
+	buckets = calloc(hdr.n_buckets, sizeof(uint32_t));
+	if (!buckets) {
+		fprintf(stderr, "ug-index: out of memory\n");
+		return -1;
+	}
+
+	for (i = 0; i < b->n_entries; i++) {
+		slot = b->entries[i].hash & (hdr.n_buckets - 1);
+		b->entries[i].next = buckets[slot];
+		buckets[slot] = i + 1;
+	}
+
+	hdr.dirs_off = sizeof(hdr);
+	hdr.buckets_off = hdr.dirs_off + b->n_dirs * sizeof(struct ug_index_dir);
+	hdr.entries_off = hdr.buckets_off + hdr.n_buckets * sizeof(uint32_t);
+	hdr.strings_off = hdr.entries_off +
+			  b->n_entries * sizeof(struct ug_index_entry);
+	hdr.size = hdr.strings_off + b->str.len;
+
+	snprintf(tmp, PATH_MAX, "%s.tmp", out);
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "ug-index: %s: %s\n", tmp, strerror(errno));
+		free(buckets);
+		return -1;
+	}
+
+	r = write_all(fd, &hdr, sizeof(hdr));
+	if (!r)
+		r = write_all(fd, b->dirs, b->n_dirs * sizeof(*b->dirs));
+	if (!r)
+		r = write_all(fd, buckets, hdr.n_buckets * sizeof(uint32_t));
+	if (!r)
+		r = write_all(fd, b->entries,
+			      b->n_entries * sizeof(*b->entries));
+	if (!r)
+		r = write_all(fd, b->str.buf, b->str.len);
+	if (!r)
+		r = fsync(fd);
+	close(fd);
+	free(buckets);
+
+	/* readers only ever see a complete index */
+	if (r || rename(tmp, out)) {
+		fprintf(stderr, "ug-index: %s: %s\n", out, strerror(errno));
+		unlink(tmp);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void usage(void)
+{
+	printf("Usage: ug-index [-v] [-o FILE]\n"
+	       "Build the UI gadget index (default: %s)\n", UG_INDEX_FILE);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *out = UG_INDEX_FILE;
+	struct builder b;
+	int opt;
+
+	memset(&b, 0, sizeof(b));
+
+	while ((opt = getopt(argc, argv, "o:vh")) != -1) {
+		switch (opt) {
+		case 'o':
+			out = optarg;
+			break;
+		case 'v':
+			b.verbose = 1;
+			break;
+		default:
+			usage();
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	/* offset 0 is the empty string */
+	b.str.buf = grow(b.str.buf, &b.str.cap, 1, 1);
+	b.str.buf[0] = '\0';
+	b.str.len = 1;
+
+	scan(&b);
+
+	if (emit(&b, out))
+		return 1;
+
+	if (b.verbose)
+		printf("%u gadgets indexed in %s\n", b.n_entries, out);
+
+	return 0;
+}
@@ -0,0 +1,402 @@
+/*
+ *  UI Gadget
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Jayoun Lee <airjany@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * ug-top: shows the live counters, the deferred job lags and the gadget
+ * tree that processes started with UG_METRICS=1 publish in
+ * /dev/shm/ug-metrics.<pid> (see ug-metrics.h).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "ug-metrics.h"
+
+#define UG_TOP_PROCS_MAX 64
+#define UG_TOP_DEPTH_MAX 32
+
+/* follow enum ug_state, enum ug_layout_state and enum ug_mode */
+static const char *state_names[] = {
+	"ready", "created", "running", "stopped", "destroying", "destroyed"
+};
+
+static const char *layout_names[] = {
+	"init", "show", "showeffect", "hide", "hideeffect", "destroy",
+	"noeffect"
+};
+
+static const char *mode_names[] = { "fullview", "frameview" };
+
+#define NAME(tab, i) \
+	((i) < sizeof(tab) / sizeof(tab[0]) ? tab[i] : "?")
+
+struct proc {
+	pid_t pid;
+	const struct ug_metrics *m;
+	/* the previous sample, for the rates */
+	struct ug_metrics prev;
+	double prev_time;
+	int seen;
+};
+
+static struct proc procs[UG_TOP_PROCS_MAX];
+static int n_procs;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const struct ug_metrics *attach(pid_t pid)
+{
+	struct ug_metrics *m;
+	struct stat st;
+	char name[64];
+	int fd;
+
+	snprintf(name, sizeof(name), UG_METRICS_SHM, pid);
+	fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st) || st.st_size < (off_t)sizeof(struct ug_metrics)) {
+		close(fd);
+		return NULL;
+	}
+
+	m = mmap(NULL, sizeof(struct ug_metrics), PROT_READ, MAP_SHARED, fd,
+		 0);
+	close(fd);
+	if (m == MAP_FAILED)
+		return NULL;
+
+	if (m->magic != UG_METRICS_MAGIC || m->version != UG_METRICS_VERSION
+	    || m->size != sizeof(struct ug_metrics)) {
+		munmap(m, sizeof(struct ug_metrics));
+		return NULL;
+	}
+
+	return m;
+}
+
+static void proc_add(pid_t pid)
+{
+	const struct ug_metrics *m;
+	char name[64];
+	int i;
+
+	for (i = 0; i < n_procs; i++) {
+		if (procs[i].pid == pid) {
+			procs[i].seen = 1;
+			return;
+		}
+	}
+
+	/* segments of dead processes are left behind by crashes */
+	if (kill(pid, 0) && errno == ESRCH) {
+		snprintf(name, sizeof(name), UG_METRICS_SHM, pid);
+		shm_unlink(name);
+		return;
+	}
+
+	if (n_procs == UG_TOP_PROCS_MAX)
+		return;
+
+	m = attach(pid);
+	if (!m)
+		return;
+
+	memset(&procs[n_procs], 0, sizeof(struct proc));
+	procs[n_procs].pid = pid;
+	procs[n_procs].m = m;
+	procs[n_procs].seen = 1;
+	n_procs++;
+}
+
+static void procs_scan(void)
+{
+	struct dirent *de;
+	char *end;
+	DIR *dir;
+	long pid;
+
+	dir = opendir("/dev/shm");
+	if (!dir)
+		return;
+
+	while ((de = readdir(dir))) {
+		if (strncmp(de->d_name, "ug-metrics.", 11))
+			continue;
+		pid = strtol(de->d_name + 11, &end, 10);
+		if (*end || pid <= 0)
+			continue;
+		proc_add(pid);
+	}
+
+	closedir(dir);
+}
+
+static void procs_prune(void)
+{
+	int i = 0;
+
+	while (i < n_procs) {
+		if (procs[i].seen && !(kill(procs[i].pid, 0) && errno == ESRCH)) {
+			i++;
+			continue;
+		}
+		munmap((void *)procs[i].m, sizeof(struct ug_metrics));
+		procs[i] = procs[--n_procs];
+	}
+}
+
+static double rate(uint64_t cur, uint64_t prev, double dt)
+{
+	return dt > 0 ? (cur - prev) / dt : 0;
+}
+
+/* nodes is a private copy, so the tree walk sees a stable picture */
+static void tree_print(const struct ug_metrics_node *nodes, uint64_t parent,
+		       int depth)
+{
+	const struct ug_metrics_node *n;
+	int i;
+
+	if (depth == UG_TOP_DEPTH_MAX)
+		return;
+
+	for (i = 0; i < UG_METRICS_NODES; i++) {
+		n = &nodes[i];
+		if (!n->ug || n->parent != parent)
+			continue;
+
+		printf("    %*s%-*s %-9s %-10s %-10s 0x%llx\n", depth * 2, "",
+		       32 - depth * 2, n->name[0] ? n->name : "(root)",
+		       NAME(mode_names, n->mode),
+		       NAME(state_names, n->state),
+		       NAME(layout_names, n->layout),
+		       (unsigned long long)n->ug);
+		tree_print(nodes, n->ug, depth + 1);
+	}
+}
+
+/* upper bound of the bucket the p-th fraction of runs falls in, in us */
+static unsigned long long lag_percentile(const struct ug_metrics_job *j,
+					 double p)
+{
+	uint64_t seen = 0;
+	uint64_t rank;
+	int b;
+
+	rank = j->runs * p;
+	if (rank >= j->runs)
+		rank = j->runs - 1;
+
+	for (b = 0; b < UG_METRICS_LAG_BUCKETS; b++) {
+		seen += j->lag_hist[b];
+		if (seen > rank)
+			break;
+	}
+
+	return 2ULL << b;
+}
+
+static void jobs_print(const struct ug_metrics *m,
+		       const struct ug_metrics *o, double dt)
+{
+	const struct ug_metrics_job *j;
+	int i;
+
+	printf("    %-24s %7s %10s %8s %10s %10s %10s %10s %8s\n", "job",
+	       "queued", "runs", "runs/s", "avg lag", "p50 <", "p99 <",
+	       "max lag", "late");
+
+	for (i = 0; i < UG_METRICS_JOBS; i++) {
+		j = &m->jobs[i];
+		if (!j->name[0] || !j->runs)
+			continue;
+
+		printf("    %-24.*s %7lld %10llu %8.1f %8llu us %7llu us "
+		       "%7llu us %7llu us %8llu\n",
+		       UG_METRICS_JOB_NAME_LEN, j->name, (long long)j->queued,
+		       (unsigned long long)j->runs,
+		       rate(j->runs, o->jobs[i].runs, dt),
+		       (unsigned long long)(j->lag_sum / j->runs / 1000),
+		       lag_percentile(j, 0.5), lag_percentile(j, 0.99),
+		       (unsigned long long)(j->lag_max / 1000),
+		       (unsigned long long)j->late);
+	}
+}
+
+static void tree_snapshot(const struct ug_metrics *m,
+			  struct ug_metrics_node *nodes)
+{
+	uint64_t ug;
+	int i;
+
+	for (i = 0; i < UG_METRICS_NODES; i++) {
+		ug = __atomic_load_n(&m->nodes[i].ug, __ATOMIC_ACQUIRE);
+		if (ug)
+			memcpy(&nodes[i], &m->nodes[i],
+			       sizeof(struct ug_metrics_node));
+		/* reused while copying: drop it */
+		if (!ug || __atomic_load_n(&m->nodes[i].ug, __ATOMIC_ACQUIRE)
+		    != ug)
+			memset(&nodes[i], 0, sizeof(struct ug_metrics_node));
+		nodes[i].name[UG_METRICS_NAME_LEN - 1] = '\0';
+	}
+}
+
+static void proc_print(struct proc *p, double t)
+{
+	static struct ug_metrics cur;
+	const struct ug_metrics *m = &cur;
+	const struct ug_metrics *o = &p->prev;
+	double dt = p->prev_time ? t - p->prev_time : 0;
+	int64_t alive = 0;
+	unsigned int i;
+
+	memcpy(&cur, p->m, sizeof(struct ug_metrics));
+	tree_snapshot(p->m, cur.nodes);
+
+	for (i = 0; i < UG_METRICS_STATES; i++)
+		alive += m->alive[i];
+
+	printf("pid %d: %lld gadgets alive (", p->pid, (long long)alive);
+	for (i = 0; i < sizeof(state_names) / sizeof(state_names[0]); i++)
+		printf("%s%s %lld", i ? ", " : "", state_names[i],
+		       (long long)m->alive[i]);
+	printf(")\n");
+
+	printf("  creates %llu (%.1f/s), destroys %llu (%.1f/s), "
+	       "module cache %llu hits, %llu misses, %lld resident\n",
+	       (unsigned long long)m->creates,
+	       rate(m->creates, o->creates, dt),
+	       (unsigned long long)m->destroys,
+	       rate(m->destroys, o->destroys, dt),
+	       (unsigned long long)m->module_hits,
+	       (unsigned long long)m->module_misses,
+	       (long long)m->modules_resident);
+	printf("  idlers %lld queued, %llu run (%.1f/s), events %llu "
+	       "(%.1f/s), key events %llu\n",
+	       (long long)m->idlers, (unsigned long long)m->idlers_run,
+	       rate(m->idlers_run, o->idlers_run, dt),
+	       (unsigned long long)m->events, rate(m->events, o->events, dt),
+	       (unsigned long long)m->key_events);
+	printf("  messages %llu (%llu bytes), results %llu (%llu bytes)\n",
+	       (unsigned long long)m->messages,
+	       (unsigned long long)m->message_bytes,
+	       (unsigned long long)m->results,
+	       (unsigned long long)m->result_bytes);
+	if (m->nodes_dropped)
+		printf("  %llu gadgets are missing from the tree\n",
+		       (unsigned long long)m->nodes_dropped);
+
+	jobs_print(m, o, dt);
+
+	tree_print(cur.nodes, 0, 0);
+	printf("\n");
+
+	memcpy(&p->prev, &cur, sizeof(struct ug_metrics));
+	p->prev_time = t;
+}
+
+static void usage(void)
+{
+	printf("Usage: ug-top [-d SECONDS] [-n COUNT] [PID...]\n"
+	       "  -d SECONDS  refresh interval (default 1)\n"
+	       "  -n COUNT    exit after COUNT refreshes\n"
+	       "Without PIDs every process publishing metrics is shown.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	double delay = 1.0;
+	long count = -1;
+	int tty = isatty(STDOUT_FILENO);
+	int pids = 0;
+	int opt;
+	int i;
+
+	while ((opt = getopt(argc, argv, "d:n:h")) != -1) {
+		switch (opt) {
+		case 'd':
+			delay = atof(optarg);
+			break;
+		case 'n':
+			count = atol(optarg);
+			break;
+		case 'h':
+			usage();
+			return 0;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	for (i = optind; i < argc; i++) {
+		proc_add(atoi(argv[i]));
+		pids = 1;
+	}
+
+	if (pids && !n_procs) {
+		fprintf(stderr, "ug-top: no metrics for the given processes\n");
+		return 1;
+	}
+
+	while (count--) {
+		double t = now();
+
+		for (i = 0; i < n_procs; i++)
+			procs[i].seen = pids;
+		if (!pids)
+			procs_scan();
+		procs_prune();
+
+		if (tty)
+			printf("\033[H\033[2J");
+
+		if (!n_procs)
+			printf("no process publishes ug metrics\n");
+		for (i = 0; i < n_procs; i++)
+			proc_print(&procs[i], t);
+		fflush(stdout);
+
+		if (count)
+			usleep(delay * 1000000);
+	}
+
+	return 0;
+}